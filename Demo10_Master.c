@@ -0,0 +1,230 @@
+/*I2C to UART bridge. Master is an MSP430FR5969 Launchpad that polls a slave for 10 bytes (Demo6_Slave.c or any
+  slave returning 10 bytes on a read) and forwards every received payload out of eUSCI_A0 as a framed, timestamped
+  binary packet. Packets are queued in a TX ring buffer that is drained by the UART transmit interrupt, so the
+  next I2C read runs while the previous packet is still being sent. If the ring is full the packet is dropped
+  but its sequence number is still consumed, so the host sees the gap. Host side: host/i2c_capture.c.
+  Packet format (little endian):
+    0xA5 0x5A  sync
+    Seq        8-bit sequence number, increments for every payload read
+    Len        payload length
+    Time       32-bit timestamp in ACLK (VLO) ticks from Timer_A1, ~10 kHz
+    Payload    Len bytes
+    Check      8-bit sum of Seq..Payload, two's complement so the sum of Seq..Check is 0
+  MCLK and SMCLK run from the DCO at 8 MHz. Master idles in LPM3 when the ring is empty and in LPM0 until the
+  next poll if the UART still had data to send.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+    P2.0  UCA0TXD to host (Launchpad backchannel UART or external USB-UART)
+    P2.1  UCA0RXD
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define PERIOD 100 //Polling period in VLO counts. 10000 count is approximately 1 second
+# define NBYTES 10 //Payload size read from slave
+# define HEADER 8 //Sync, Seq, Len, Time
+# define RING 256 //TX ring size. Must be 256 so the 8-bit indices wrap by themselves
+//# define BAUD_1M //Uncomment for 1 Mbaud on an external USB-UART; default is 115200 for the backchannel
+volatile uint8_t RxCount, RxData[NBYTES];
+volatile uint8_t *PRxData;   // Pointer to RX data
+volatile uint8_t Ring[RING];
+volatile uint8_t Head, Tail; //Head written only by main, Tail only by the UART ISR
+volatile uint16_t TimeHigh; //Upper half of the 32-bit timestamp
+volatile uint16_t Dropped; //Packets lost to a full ring
+uint8_t Seq, Check, i;
+
+//Free bytes in the ring. One slot is kept empty to tell full from empty
+uint8_t RingFree(void)
+{
+    return (uint8_t)(Tail - Head - 1);
+}
+
+void RingPut(uint8_t b)
+{
+    Ring[Head] = b;
+    Head++; //Single byte write is atomic; ISR sees the byte only after this
+}
+
+//32-bit VLO timestamp; re-read if Timer_A1 overflowed in between
+uint32_t Timestamp(void)
+{
+    uint16_t high, low;
+    do {
+        high = TimeHigh;
+        low = TA1R;
+    } while (high != TimeHigh);
+    return ((uint32_t)high << 16) | low;
+}
+
+//Frame the payload into the ring and start the UART if it is idle
+void SendPacket(void)
+{
+    uint32_t time;
+    time = Timestamp();
+    if (RingFree() < HEADER + NBYTES + 1)
+    {
+        Dropped++; //No room; the sequence gap tells the host
+        Seq++;
+        return;
+    }
+    RingPut(0xA5);
+    RingPut(0x5A);
+    RingPut(Seq);
+    RingPut(NBYTES);
+    Check = Seq + NBYTES;
+    for (i=0;i<4;i++)
+    {
+        RingPut((uint8_t)time);
+        Check += (uint8_t)time;
+        time >>= 8;
+    }
+    for (i=0;i<NBYTES;i++)
+    {
+        RingPut(RxData[i]);
+        Check += RxData[i];
+    }
+    RingPut((uint8_t)(-Check));
+    Seq++;
+    UCA0IE |= UCTXIE; //TXIFG is set while idle, so the ISR starts sending right away
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P2SEL1 |= BIT0 + BIT1; //Setup UART on UCA0
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    CSCTL1 = DCOFSEL_6; //DCO at 8 MHz
+    CSCTL2 = SELA__VLOCLK + SELS__DCOCLK + SELM__DCOCLK;  //ACLK from VLO; SMCLK and MCLK from DCO
+    CSCTL3 = DIVA__1 + DIVS__1 + DIVM__1; //No dividers
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+
+    //Timer A0 sets the polling period; MC_1 to count up to TA0CCR0 on ACLK (VLO)
+    TA0CCTL0 |= CCIE;
+    TA0CTL |= MC_1 + TASSEL_1;
+    //Timer A1 free runs on ACLK for timestamps; overflow extends it to 32 bits
+    TA1CTL |= MC_2 + TASSEL_1 + TACLR + TAIE;
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, receiver, synchronous, I2C
+    UCB0BRW = 80;  //Divide 8 MHz SMCLK by 80 to get ~100 kHz
+    UCB0I2CSA = 0x77; // FR2355 address
+    UCB0CTLW0 &= ~UCSWRST; // Clear reset
+    UCB0IE |= UCRXIE0; //Enable I2C receive interrupt
+
+    // Configure the eUSCI_A0 module as UART, 8N1
+    UCA0CTLW0 = UCSWRST;
+    UCA0CTLW0 |= UCSSEL__SMCLK;
+#ifdef BAUD_1M
+    UCA0BRW = 8; //8 MHz / 8, no oversampling
+    UCA0MCTLW = 0;
+#else
+    UCA0BRW = 4; //8 MHz / 115200 = 69.44; oversampling with UCBRF = 5, UCBRS = 0x55
+    UCA0MCTLW = UCOS16 + UCBRF_5 + 0x5500;
+#endif
+    UCA0CTLW0 &= ~UCSWRST;
+
+    __enable_interrupt(); //Enable global interrupts.
+    Seq = 0;
+    Dropped = 0;
+
+    while(1)
+    {
+        TA0CCR0 = PERIOD; //Looping period with VLO
+        //LPM3 if nothing is left to send; otherwise LPM0 keeps SMCLK on for the UART
+        __disable_interrupt();
+        if (Head == Tail) __bis_SR_register(LPM3_bits + GIE);
+        else __bis_SR_register(LPM0_bits + GIE);
+        //Timeout
+        PRxData = (uint8_t *)RxData;    // Point to start of RX array
+        RxCount = NBYTES; //Read entire data register from slave
+        UCB0CTLW0 |= UCTXSTT; //Start read
+        LPM0; //Wait for I2C; UART keeps draining the ring meanwhile
+        SendPacket();
+        P1OUT ^= BIT0; //Green LED toggles on every payload
+        if (Dropped) P4OUT |= BIT6; //Red LED latches once a packet is lost
+    }
+}
+#pragma vector=TIMER0_A0_VECTOR
+ __interrupt void TIMER_A0 (void)
+{
+    LPM3_EXIT;
+}
+
+#pragma vector=TIMER1_A1_VECTOR
+ __interrupt void TIMER_A1 (void)
+{
+    switch(__even_in_range(TA1IV, TA1IV_TAIFG))
+    {
+        case TA1IV_TAIFG: TimeHigh++; break; //Timestamp overflow
+        default: break;
+    }
+}
+
+#pragma vector = USCI_A0_VECTOR
+__interrupt void USCI_A0_ISR(void)
+{
+    switch(__even_in_range(UCA0IV, USCI_UART_UCTXCPTIFG))
+    {
+        case USCI_NONE: break;
+        case USCI_UART_UCRXIFG: break;
+        case USCI_UART_UCTXIFG:
+                        if (Head != Tail)
+                            {
+                                UCA0TXBUF = Ring[Tail]; //Send next byte from ring
+                                Tail++;
+                            }
+                        else UCA0IE &= ~UCTXIE; //Ring empty; main re-enables on next packet
+                        break;
+        case USCI_UART_UCSTTIFG: break;
+        case USCI_UART_UCTXCPTIFG: break;
+        default: break;
+    }
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4: break;         // Vector 4: NACKIFG
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24: break;         // Vector 24: TXIFG0
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
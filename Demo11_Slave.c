@@ -0,0 +1,188 @@
+ /*I2C demo with MSP430FR2355 Launchpad as SLAVE with on-device performance counters. Data exchange on 0x77 is the
+  same as Demo6: bytes written by the master overwrite TxData, and all 10 bytes of TxData are sent back on a read.
+  Slave is held in LPM4 between transactions and wakes on the stop condition. The counters below are always on and
+  are published at the second own address 0x78, so any master can read them without a debugger. A read at 0x78
+  returns a snapshot taken at the first byte; writing 0xC1 to 0x78 clears them. Counter window (little endian):
+    Offset  0  BytesRx       uint32  data bytes received on 0x77
+    Offset  4  BytesTx       uint32  data bytes sent on 0x77
+    Offset  8  Transactions  uint32  start conditions addressed to this slave
+    Offset 12  Nacks         uint16  bytes refused with NACK because RxData was full
+    Offset 14  Timeouts      uint16  clock low timeouts (bus reset as in Demo7_Slave_alternative.c)
+    Offset 16  Wakeups       uint16  wake-ups from LPM4
+    Offset 18  MaxIsr        uint16  longest I2C ISR including entry and RETI, SMCLK cycles
+    Offset 20  MaxStretch    uint16  longest SCL stretch before the first byte of a read on 0x77, SMCLK cycles
+  Times are measured with Timer_B0 free running on SMCLK from the first interrupt of a transaction to its stop
+  condition, so its clock request keeps SMCLK on during a transaction only. A read stretches SCL from the address
+  ACK, where STTIFG and TXIFG0 are set together, until UCB0TXBUF is loaded; MaxStretch counts from the START
+  interrupt request (timer stamp at entry minus ENTRY cycles) to that load. Later bytes are double buffered by the
+  eUSCI and only stretch if the TXIFG0 ISR comes more than a byte time late. The LPM4 wake-up time passes before
+  SMCLK runs and adds to both figures as seen by the master.
+  Master code is Demo6_Master.c; point UCB0I2CSA at 0x78 to read the counters.
+    P1.2  UCB0SDA with 10k pullup
+    P1.3  UCB0SCL with 10k pullup
+ */
+ #include <msp430.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #define NBYTES 10
+ #define STAT_ADDR 0x78 //Reserved address for the counter window
+ #define STAT_CLEAR 0xC1 //Command byte written to STAT_ADDR to clear the counters
+ #define ENTRY 6 //Cycles from the interrupt request to the first ISR instruction
+ #define RETI 5 //Cycles of the return from interrupt
+
+ typedef struct {
+     uint32_t BytesRx, BytesTx, Transactions;
+     uint16_t Nacks, Timeouts, Wakeups, MaxIsr, MaxStretch;
+ } Counters_t;
+
+ volatile Counters_t Stats; //Live counters, updated in the ISR
+ Counters_t Snapshot; //Copy sent to the master so a read is consistent
+ volatile uint8_t TxData[]={1,2,3,4,5,6,7,8,9,10}, TxCount;
+ volatile uint8_t RxData[NBYTES], RxCount;
+ volatile uint8_t *PTxData, *PRxData, *PStat;   // Pointers to data arrays
+ volatile uint8_t StatCount, reg_reset;
+ uint16_t Mark; //Timer_B0 count at the START interrupt request
+ uint8_t i;
+
+ int main(void)
+ {
+     WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+     PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+     P1DIR |= BIT0; //Red LED on Launchpad
+     P6DIR |= BIT6; //Green LED on Launchpad
+     P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+     P1OUT &= ~BIT0; //Turn off LEDs
+     P6OUT &= ~BIT6;
+
+     TB0CTL = TBSSEL__SMCLK; //Timer B0 stopped; the ISR runs it on SMCLK during a transaction
+
+     //Setup I2C
+     UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+     UCB0CTLW1 |= UCCLTO_3;                    // 34 ms I2C bus timeout
+     UCB0I2COA0 = 0x77 | UCOAEN;               // Slave address is 0x77; enable it
+     UCB0I2COA1 = STAT_ADDR | UCOAEN;          // Counter window on second own address
+     UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+
+     UCB0IE |= UCRXIE0 + UCTXIE0 + UCRXIE1 + UCTXIE1 + UCSTTIE + UCSTPIE + UCCLTOIE;
+     __enable_interrupt(); //Enable global interrupts.
+
+     PRxData = (uint8_t *)RxData;
+     PTxData = (uint8_t *)TxData;
+     TxCount = NBYTES;
+     RxCount = 0;
+
+     while(1){
+         LPM4; //Wait for stop condition in LPM4
+         Stats.Wakeups++;
+         //Execute the following if data received. Update TxData with new bytes. Slave will send TxData when requested.
+         if(RxCount != 0){
+             for (i=0;i<RxCount;i++) TxData[i] = RxData[i]; //Overwrite TxData
+             RxCount = 0;
+         }
+         //Simple test of the TX data; look at 3rd byte
+         if(TxData[2]==0x03) { P6OUT |= BIT6; P1OUT &= ~BIT0; } //Green
+         else { P1OUT |= BIT0; P6OUT &= ~BIT6; } //Red
+         }
+ }
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint16_t start, elapsed;
+   uint8_t stop = 0;
+   if (!(TB0CTL & MC__CONTINUOUS)) TB0CTL = TBSSEL__SMCLK + MC__CONTINUOUS + TBCLR; //First interrupt of a transaction
+   start = TB0R;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;           // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                  // Vector 6: STTIFG
+                             Stats.Transactions++;
+                             Mark = start - ENTRY; //SCL is held from here until TXBUF is loaded on a read
+                             PRxData = (uint8_t *)RxData;    //Rewind all pointers for the new transaction
+                             RxCount = 0;
+                             UCB0CTLW0 &= ~UCTXNACK; //Left set if the last write stopped at a full buffer
+                             PTxData = (uint8_t *)TxData;
+                             TxCount = NBYTES;
+                             StatCount = 0;
+                             break;
+     case USCI_I2C_UCSTPIFG:                  // Vector 8: STPIFG
+                             UCB0IFG &= ~UCSTPIFG;
+                             stop = 1;
+                             LPM4_EXIT;
+                             break;
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1:                 // Vector 20: RXIFG1. Command to the counter window
+                             if (UCB0RXBUF == STAT_CLEAR)
+                             {
+                                 Stats.BytesRx = Stats.BytesTx = Stats.Transactions = 0;
+                                 Stats.Nacks = Stats.Timeouts = Stats.Wakeups = 0;
+                                 Stats.MaxIsr = Stats.MaxStretch = 0;
+                             }
+                             break;
+     case USCI_I2C_UCTXIFG1:                 // Vector 22: TXIFG1. Counter window read
+                             if (StatCount == 0)
+                             {
+                                 Snapshot = Stats;
+                                 PStat = (uint8_t *)&Snapshot;
+                             }
+                             if (StatCount < sizeof(Snapshot))
+                             {
+                                 UCB0TXBUF = *PStat++;
+                                 StatCount++;
+                             }
+                             else UCB0TXBUF = 0xFF; //Past the end of the window
+                             break;
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             if (RxCount < NBYTES)
+                             {
+                                 *PRxData++ = UCB0RXBUF;
+                                 RxCount++;
+                                 Stats.BytesRx++;
+                                 if (RxCount == NBYTES) UCB0CTLW0 |= UCTXNACK; //Buffer full; NACK the next byte
+                             }
+                             else //This byte was refused with NACK
+                             {
+                                 UCB0RXBUF;
+                                 Stats.Nacks++;
+                             }
+                             break;
+     case USCI_I2C_UCTXIFG0:                 // Vector 26: TXIFG0
+                             if (TxCount)      // Check TX byte counter not empty
+                             {
+                                 UCB0TXBUF = *PTxData++; // Load TX buffer
+                                 if (TxCount == NBYTES) //First byte: SCL released now
+                                 {
+                                     elapsed = TB0R - Mark;
+                                     if (elapsed > Stats.MaxStretch) Stats.MaxStretch = elapsed;
+                                 }
+                                 TxCount--;            // Decrement TX byte counter
+                                 Stats.BytesTx++;
+                             }
+                             else UCB0TXBUF = 0xFF; //Master read past the end
+                             break;
+     case USCI_I2C_UCBCNTIFG: break;            // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG:                // Vector 30: clock low timeout. Try to reset I2C bus
+                             Stats.Timeouts++;
+                             reg_reset = UCB0IE;        // Save current IE bits
+                             P1SEL0 &= ~(BIT2);         // Generate NACK by releasing SDA
+                             P1SEL0 &= ~(BIT3);         //  then SCL by disconnecting from the I2C
+                             UCB0CTLW0 |= UCSWRST;      // Reset
+                             UCB0CTLW0 &= ~UCSWRST;
+                             P1SEL0 |=  (BIT2|BIT3);    // Re-connect pins to I2C
+                             UCB0IE = reg_reset;        // Reset interrupt register
+                             UCB0IFG &= ~UCCLTOIFG;     //Clear interrupt flag
+                             stop = 1;
+                             break;
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+   elapsed = TB0R - start + ENTRY + RETI;
+   if (elapsed > Stats.MaxIsr) Stats.MaxIsr = elapsed;
+   if (stop) TB0CTL = TBSSEL__SMCLK; //Stop the timer so it does not request SMCLK in LPM4
+ }
@@ -0,0 +1,205 @@
+/*I2C firmware uploader for the Demo12_Slave.c bootloader. Master is an MSP430FR5969 Launchpad, slave is an
+  MSP430FR2355 Launchpad at 0x77. Press P1.1 to send the application image in blocks of up to BLOCK bytes.
+  Each block is one write transaction using the same TX interrupt path as Demo6_Master.c; blocks are sent back
+  to back with no reply per block, and the slave stretches the clock if it falls behind. After the last block
+  the master polls the 6-byte status until the slave is no longer busy. If any block failed, the whole image is
+  sent once more; otherwise CMD_BOOT starts the new firmware. Green LED: update done. Red LED: update failed.
+  CRC16-CCITT of each block comes from the FR5969 hardware CRC module, which matches the one on the FR2355.
+  The image is a list of segments (address, length, data). Replace the example with the application, e.g. from
+  hex430 output; it must include the entry address word at 0xDFFE.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define BLOCK 128 //Must not exceed BLOCK in the bootloader
+# define CMD_START 0x53
+# define CMD_WRITE 0x57
+# define CMD_BOOT 0x42
+# define ST_BUSY BIT0
+# define ST_ERRORS (BIT1 + BIT2 + BIT3 + BIT4)
+# define NSEGMENTS 2
+
+typedef struct {
+    uint16_t Addr, Len;
+    const uint8_t *Data;
+} Segment_t;
+
+//Example image: JMP $ at 0x8000 and the entry address 0x8000 at 0xDFFE
+const uint8_t Code[] = {0xFF, 0x3F};
+const uint8_t Entry[] = {0x00, 0x80};
+const Segment_t Image[NSEGMENTS] = {{0x8000, sizeof(Code), Code}, {0xDFFE, sizeof(Entry), Entry}};
+
+volatile uint8_t RxCount, TxCount, RxData[6], TxData[BLOCK + 6];
+volatile uint8_t *PRxData, *PTxData;   // Pointers to RX and TX data
+uint16_t Blocks;
+uint8_t Attempt;
+
+uint16_t Crc16(const volatile uint8_t *p, uint16_t n)
+{
+    CRCINIRES = 0xFFFF;
+    while (n--) CRCDI_L = *p++;
+    return CRCINIRES;
+}
+
+//Send TxData[0..n-1] as one write transaction
+void Send(uint8_t n)
+{
+    PTxData = (uint8_t *)TxData;
+    TxCount = n;
+    UCB0CTLW0 |= UCTR + UCTXSTT; // Set to transmit and start
+    LPM0;    // Remain in LPM0 until all data transmitted
+    while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+}
+
+//Read the 6-byte bootloader status into RxData
+void ReadStatus(void)
+{
+    UCB0CTLW0 &= ~UCTR; //Set as receiver
+    PRxData = (uint8_t *)RxData;
+    RxCount = sizeof(RxData);
+    UCB0CTLW0 |= UCTXSTT; //Start read
+    LPM0; //Wait for I2C
+    while (UCB0CTLW0 & UCTXSTP);
+}
+
+//Send every segment of the image as blocks. Returns the number of blocks sent
+uint16_t SendImage(void)
+{
+    uint16_t n, addr, crc, count = 0;
+    uint8_t s, len, i;
+    const uint8_t *src;
+    TxData[0] = CMD_START;
+    Send(1);
+    for (s=0;s<NSEGMENTS;s++)
+    {
+        addr = Image[s].Addr;
+        src = Image[s].Data;
+        n = Image[s].Len;
+        while (n)
+        {
+            len = (n > BLOCK) ? BLOCK : n;
+            TxData[0] = CMD_WRITE;
+            TxData[1] = (uint8_t)addr;
+            TxData[2] = (uint8_t)(addr >> 8);
+            TxData[3] = len;
+            for (i=0;i<len;i++) TxData[4 + i] = *src++;
+            crc = Crc16(TxData, len + 4);
+            TxData[len + 4] = (uint8_t)crc;
+            TxData[len + 5] = (uint8_t)(crc >> 8);
+            Send(len + 6);
+            addr += len;
+            n -= len;
+            count++;
+        }
+    }
+    return count;
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT = BIT1; // Pull-up resistor on P1.1
+    P1REN = BIT1; // Select pull-up mode for P1.1
+    P1IES = BIT1; // P1.1 Hi/Lo edge
+    P1IFG = 0;    // Clear all P1 interrupt flags
+    P1IE = BIT1;  // P1.1 interrupt enabled
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0I2CSA = 0x77; // FR2355 bootloader address
+    UCB0CTLW0 &= ~UCSWRST; // Clear reset
+
+    UCB0IE |= UCTXIE0 + UCRXIE0; //Enable I2C transmission and receive interrupts
+    __enable_interrupt(); //Enable global interrupts.
+
+    while(1)
+    {
+        LPM4;       //Wait for pushbutton interrupt in low power mode
+        P1OUT &= ~BIT0; //LEDs off
+        P4OUT &= ~BIT6;
+        for (Attempt=0;Attempt<2;Attempt++)
+        {
+            Blocks = SendImage();
+            do ReadStatus(); while (RxData[0] & ST_BUSY); //Wait for the last blocks to be programmed
+            if (!(RxData[0] & ST_ERRORS) && ((RxData[1] | (RxData[2] << 8)) == Blocks)) break;
+        }
+        if (Attempt < 2)
+        {
+            TxData[0] = CMD_BOOT;
+            TxData[1] = (uint8_t)Blocks;
+            TxData[2] = (uint8_t)(Blocks >> 8);
+            Send(3);
+            P1OUT |= BIT0; //Green: new firmware started
+        }
+        else P4OUT |= BIT6; //Red: update failed; FailAddr is in RxData[3..4]
+    }
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4: break;         // Vector 4: NACKIFG
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
+
+#pragma vector=PORT1_VECTOR
+__interrupt void Port_1(void)
+{
+  P1IFG &= ~BIT1;  // Clear P1.1 IFG
+  LPM4_EXIT;     // Exit LPM4
+}
@@ -0,0 +1,246 @@
+/* I2C bootloader for in-field firmware updates of an MSP430FR2355 Launchpad SLAVE (Address 0x77).
+   Firmware images are sent by the master in large block writes, one block per I2C write transaction:
+     CMD_START                                   Clear status and start a new update
+     CMD_WRITE AddrLo AddrHi Len Data[Len] CrcLo CrcHi   Write Len (<= BLOCK) bytes to FRAM at Addr
+     CMD_BOOT  CountLo CountHi                   Mark the image valid if Count blocks were written without error, then run it
+   The CRC is CRC16-CCITT (hardware CRC module, seed 0xFFFF) over everything from the command byte to the last data byte.
+   Blocks are received into two buffers. While main checks the CRC and programs one block into FRAM, the ISR
+   already fills the other, so the master can send blocks back to back without waiting for a reply. If both buffers
+   are still busy the ISR stops reading UCB0RXBUF and the eUSCI holds SCL low until a buffer is free.
+   The master reads 6 status bytes at the end instead of a handshake per block:
+     Status  bit0 busy (blocks pending), bit1 CRC error, bit2 address range error, bit3 verify error, bit4 bad frame
+     Blocks  uint16 blocks written since CMD_START
+     FailAddr uint16 address of the first failing block
+     Reserved
+   Memory map: bootloader is linked above APP_END (restrict FRAM to 0xE000-0xFF7F in the linker command file and
+   keep the reset vector). The application is linked to APP_START-APP_END, must put its entry address in the word
+   at APP_RESET and relocate its interrupt vectors to RAM (SYSCTL SYSRIVECT). The valid flag lives in information FRAM.
+   At reset the bootloader starts the application at once unless it is not valid, button S1 (P4.1) is held, or the
+   application wrote BOOT_MAGIC to BootRequest and reset the device.
+   Master uploader is Demo12_Master.c.
+     P1.2 SDA on UCB0
+     P1.3 SCL on UCB0
+*/
+#include <msp430.h>
+#include <stdint.h>
+
+#define APP_START 0x8000
+#define APP_END 0xDFFF
+#define APP_RESET 0xDFFE //Application entry address
+#define APP_VALID 0xA55A
+#define BOOT_MAGIC 0xB007
+#define BLOCK 128 //Largest data block in one transaction
+#define FRAME (BLOCK + 6) //Command, address, length, data, CRC
+#define CMD_START 0x53
+#define CMD_WRITE 0x57
+#define CMD_BOOT 0x42
+#define ST_BUSY BIT0
+#define ST_CRC BIT1
+#define ST_RANGE BIT2
+#define ST_VERIFY BIT3
+#define ST_FRAME BIT4
+
+#pragma LOCATION(AppValid, 0x1800) //Information FRAM
+#pragma NOINIT(AppValid)
+volatile uint16_t AppValid;
+#pragma LOCATION(BootRequest, 0x1802)
+#pragma NOINIT(BootRequest)
+volatile uint16_t BootRequest;
+
+volatile uint8_t Buf[2][FRAME], BufLen[2], BufFull[2];
+volatile uint8_t Fill; //Buffer the ISR writes into
+volatile uint8_t Status[6], TxCount;
+volatile uint8_t *PTxData;
+uint16_t Blocks, FailAddr;
+uint8_t Proc; //Buffer main processes next
+
+uint16_t Crc16(const volatile uint8_t *p, uint16_t n)
+{
+    CRCINIRES = 0xFFFF;
+    while (n--) CRCDI_L = *p++;
+    return CRCINIRES;
+}
+
+void RunApplication(void)
+{
+    __disable_interrupt();
+    UCB0CTLW0 = UCSWRST; //Leave the bus to the application
+    ((void (*)(void))(*(volatile uint16_t *)APP_RESET))();
+}
+
+//Keep the status block the master reads up to date
+void UpdateStatus(uint8_t err)
+{
+    if (err && (Buf[Proc][0] == CMD_WRITE) && !(Status[0] & (ST_CRC + ST_RANGE + ST_VERIFY + ST_FRAME))) FailAddr = Buf[Proc][1] | (Buf[Proc][2] << 8);
+    Status[0] |= err;
+    if (BufFull[0] || BufFull[1]) Status[0] |= ST_BUSY;
+    else Status[0] &= ~ST_BUSY;
+    Status[1] = (uint8_t)Blocks;
+    Status[2] = (uint8_t)(Blocks >> 8);
+    Status[3] = (uint8_t)FailAddr;
+    Status[4] = (uint8_t)(FailAddr >> 8);
+}
+
+//Check and program one received frame. Returns error bits
+uint8_t WriteBlock(volatile uint8_t *b, uint8_t n)
+{
+    uint16_t addr, crc;
+    uint8_t len, i;
+    uint8_t *dst;
+    len = b[3];
+    if ((len > BLOCK) || (n != len + 6)) return ST_FRAME;
+    crc = b[len + 4] | (b[len + 5] << 8);
+    if (Crc16(b, len + 4) != crc) return ST_CRC;
+    addr = b[1] | (b[2] << 8);
+    if ((addr < APP_START) || ((uint32_t)addr + len > (uint32_t)APP_END + 1)) return ST_RANGE;
+    dst = (uint8_t *)addr;
+    SYSCFG0 = FRWPPW | PFWP; //Unlock information FRAM only
+    AppValid = 0; //Image is incomplete until CMD_BOOT
+    SYSCFG0 = FRWPPW | DFWP; //Unlock program FRAM only
+    for (i=0;i<len;i++) dst[i] = b[4 + i]; //FRAM writes at full CPU speed
+    SYSCFG0 = FRWPPW | PFWP | DFWP; //Lock FRAM again
+    for (i=0;i<len;i++) if (dst[i] != b[4 + i]) return ST_VERIFY;
+    Blocks++;
+    return 0;
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+    P4DIR &= ~BIT1; //Button S1 with pullup
+    P4REN |= BIT1;
+    P4OUT |= BIT1;
+    PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+    __delay_cycles(100); //Let the pullup settle before reading the button
+    if ((AppValid == APP_VALID) && (BootRequest != BOOT_MAGIC) && (P4IN & BIT1)) RunApplication();
+
+    P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+    P1DIR |= BIT0; //Red LED on Launchpad
+    P6DIR |= BIT6; //Green LED on Launchpad
+    P1OUT &= ~BIT0; //LEDs off
+    P6OUT |= BIT6; //Green LED on while in the bootloader
+
+    //MCLK at 8 MHz so FRAM programming and CRC keep well ahead of the bus
+    FRCTL0 = FRCTLPW | NWAITS_0; //No wait states needed at 8 MHz
+    __bis_SR_register(SCG0); //Disable FLL
+    CSCTL3 |= SELREF__REFOCLK; //FLL reference is REFO
+    CSCTL1 = DCORSEL_3; //DCO range 8 MHz
+    CSCTL2 = FLLD_0 + 243; //DCODIV = (243 + 1) * 32768 Hz = ~8 MHz
+    __delay_cycles(3);
+    __bic_SR_register(SCG0); //Enable FLL
+    while (CSCTL7 & (FLLUNLOCK0 | FLLUNLOCK1)); //Wait for FLL lock
+    CSCTL4 = SELMS__DCOCLKDIV + SELA__REFOCLK;
+
+    UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+    UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+    UCB0I2COA0 = 0x77 | UCOAEN;               // Slave address is 0x77; enable it
+    UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+    UCB0IE |= UCRXIE0 + UCTXIE0 + UCSTTIE + UCSTPIE; // Enable receive, transmit, start and stop interrupts
+
+    Fill = 0;
+    Proc = 0;
+    Blocks = 0;
+    FailAddr = 0;
+    UpdateStatus(0);
+    __enable_interrupt(); //Enable global interrupts.
+
+    while(1)
+    {
+        __disable_interrupt();
+        if (!BufFull[Proc]) __bis_SR_register(LPM0_bits + GIE); //Wait for a complete frame
+        __enable_interrupt();
+        if (!BufFull[Proc]) continue;
+
+        switch (Buf[Proc][0])
+        {
+            case CMD_START:
+                Blocks = 0;
+                FailAddr = 0;
+                Status[0] = 0;
+                P1OUT &= ~BIT0;
+                break;
+            case CMD_WRITE:
+                UpdateStatus(WriteBlock(Buf[Proc], BufLen[Proc]));
+                P6OUT ^= BIT6; //Green LED flickers while blocks arrive
+                break;
+            case CMD_BOOT:
+                if (!(Status[0] & (ST_CRC + ST_RANGE + ST_VERIFY + ST_FRAME)) &&
+                    (Blocks == (Buf[Proc][1] | (Buf[Proc][2] << 8))))
+                {
+                    SYSCFG0 = FRWPPW | PFWP;
+                    AppValid = APP_VALID;
+                    BootRequest = 0;
+                    SYSCFG0 = FRWPPW | PFWP | DFWP;
+                    while (UCB0STATW & UCBBUSY); //Let the master finish the transaction
+                    RunApplication();
+                }
+                UpdateStatus(ST_FRAME); //Refuse to boot an incomplete image
+                break;
+            default:
+                UpdateStatus(ST_FRAME);
+                break;
+        }
+        if (Status[0] & (ST_CRC + ST_RANGE + ST_VERIFY + ST_FRAME)) P1OUT |= BIT0; //Red LED on error
+
+        //Hand the buffer back to the ISR; resume reading if it was holding the clock
+        BufLen[Proc] = 0;
+        BufFull[Proc] = 0;
+        Proc ^= 1;
+        UpdateStatus(0);
+        UCB0IE |= UCRXIE0;
+    }
+}
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint8_t n;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;         // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             PTxData = (uint8_t *)Status; //Reads always return the status block
+                             TxCount = sizeof(Status);
+                             break;
+     case USCI_I2C_UCSTPIFG:                 // Vector 8: STPIFG
+                             UCB0IFG &= ~UCSTPIFG;
+                             if (BufLen[Fill] == 0) break; //Read or empty write
+                             BufFull[Fill] = 1; //Pass the frame to main
+                             Status[0] |= ST_BUSY;
+                             Fill ^= 1;
+                             LPM0_EXIT;
+                             break;
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             if (BufFull[Fill])
+                             {
+                                 //Both buffers busy. Leave the byte in RXBUF so SCL is held until main frees one
+                                 UCB0IE &= ~UCRXIE0;
+                                 break;
+                             }
+                             n = BufLen[Fill];
+                             if (n < FRAME) Buf[Fill][n] = UCB0RXBUF;
+                             else UCB0RXBUF; //Oversized frame; length check in main rejects it
+                             if (n < 0xFF) BufLen[Fill] = n + 1;
+                             break;
+     case USCI_I2C_UCTXIFG0:                 // Vector 26: TXIFG0
+                             if (TxCount)
+                             {
+                                 UCB0TXBUF = *PTxData++;
+                                 TxCount--;
+                             }
+                             else UCB0TXBUF = 0xFF;
+                             break;
+     case USCI_I2C_UCBCNTIFG: break;         // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
@@ -0,0 +1,211 @@
+/*I2C demo program for automatic bus speed negotiation. Master is an MSP430FR5969 Launchpad with SMCLK at 8 MHz.
+  At power-up the master probes every slave in its address table at increasing SCL rates. At each rate it writes
+  a test pattern, reads it back (loopback slave Demo13_Slave.c), and times the exchange with Timer_A1. The rate
+  passes if the pattern matches, the slave did not NACK, and the exchange took no more than twice its nominal
+  bit time (longer means the slave is stretching the clock). The fastest rate that passes PASSES times in a row is
+  stored as the divider for that address, and UCB0BRW is switched to it before every transaction with that slave.
+  Slaves are then polled in a timed loop at their own speed. Green LED: every slave passed its loopback at the
+  negotiated rate. Red LED: a slave failed.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define PERIOD 20000 //Samping period. 10000 count is approximately 1 second; maximum is 65535
+# define BLINK 500
+# define NSLAVES 2
+# define NSPEEDS 4
+# define NBYTES 16 //Test pattern length
+# define PASSES 3 //Consecutive good exchanges needed at each rate
+# define MARGIN 50 //Allowance in us for start, stop and ISR latency
+const uint8_t SlaveAddr[NSLAVES] = {0x77, 0x76};
+//SMCLK dividers from slowest to fastest: 50, 100, 200, 400 kHz
+const uint16_t Speed[NSPEEDS] = {160, 80, 40, 20};
+uint16_t Divider[NSLAVES]; //Negotiated divider for each address
+volatile uint8_t RxCount, TxCount, RxData[NBYTES], TxData[NBYTES], Error;
+volatile uint8_t *PRxData, *PTxData;   // Pointers to RX and TX data
+uint16_t Elapsed; //Duration of the last exchange in us
+
+//Change the SCL divider. The eUSCI must be in reset, which also clears its interrupt enables
+void SetSpeed(uint16_t div)
+{
+    uint16_t ie;
+    if (UCB0BRW == div) return;
+    ie = UCB0IE;
+    UCB0CTLW0 |= UCSWRST;
+    UCB0BRW = div;
+    UCB0CTLW0 &= ~UCSWRST;
+    UCB0IE = ie;
+}
+
+//Write TxData, read it back into RxData and time the whole exchange. Returns 1 if the pattern came back intact
+uint8_t Loopback(uint8_t slave, uint16_t div)
+{
+    uint8_t i;
+    SetSpeed(div);
+    UCB0I2CSA = SlaveAddr[slave];
+    Error = 0;
+    TA1CTL = TASSEL__SMCLK + ID__8 + MC__CONTINUOUS + TACLR; //1 us ticks
+
+    PTxData = (uint8_t *)TxData;
+    TxCount = NBYTES;
+    UCB0CTLW0 |= UCTR + UCTXSTT; // Set to transmit and start
+    LPM0;    // Remain in LPM0 until all data transmitted
+    while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+    if (!Error)
+    {
+        UCB0CTLW0 &= ~UCTR; //Set as receiver
+        PRxData = (uint8_t *)RxData;
+        RxCount = NBYTES;
+        UCB0CTLW0 |= UCTXSTT; //Start read
+        LPM0; //Wait for I2C
+        while (UCB0CTLW0 & UCTXSTP);
+    }
+    Elapsed = TA1R;
+    TA1CTL = MC__STOP; //Timer off so it does not hold SMCLK in LPM3
+    if (Error) return 0;
+    for (i=0;i<NBYTES;i++) if (RxData[i] != TxData[i]) return 0;
+    //Nominal time: 2 transfers of address + NBYTES, 9 clocks per byte, div/8 us per clock
+    if (Elapsed > (uint16_t)(2 * (NBYTES + 1) * 9 * (uint32_t)div / 8 * 2 + MARGIN)) return 0;
+    return 1;
+}
+
+//Find the fastest reliable divider for a slave, starting from the slowest rate
+void Probe(uint8_t slave)
+{
+    uint8_t i, n, s;
+    Divider[slave] = Speed[0];
+    for (s=0;s<NSPEEDS;s++)
+    {
+        for (n=0;n<PASSES;n++)
+        {
+            for (i=0;i<NBYTES;i++) TxData[i] = (i & 1) ? 0x55 ^ (n + s) : 0xAA ^ (i << 3); //Alternating bits
+            if (!Loopback(slave, Speed[s])) return; //Keep the last rate that passed
+        }
+        Divider[slave] = Speed[s];
+    }
+}
+
+void main(void) {
+
+    uint8_t i, s, Good;
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    CSCTL1 = DCOFSEL_6; //DCO at 8 MHz
+    CSCTL2 = SELA__VLOCLK + SELS__DCOCLK + SELM__DCOCLK;  //ACLK from VLO; SMCLK and MCLK from DCO
+    CSCTL3 = DIVA__1 + DIVS__1 + DIVM__1; //No dividers
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+
+    //Enable the timer interrupt, MC_1 to count up to TA0CCR0, Timer A set to ACLK (VLO)
+    TA0CCTL0 |= CCIE;
+    TA0CTL |= MC_1 + TASSEL_1;
+
+    // Configure the eUSCI_B0 module for I2C, starting at the slowest rate
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0CTLW1 |= UCCLTO_1; //Give up on a slave that holds SCL low for ~28 ms
+    UCB0BRW = Speed[0];
+    UCB0CTLW0 &= ~UCSWRST; // Clear reset
+
+    UCB0IE |= UCTXIE0 + UCRXIE0 + UCNACKIE + UCCLTOIE; //Enable I2C transmission, receive, NACK and timeout interrupts
+    __enable_interrupt(); //Enable global interrupts.
+
+    for (i=0;i<NSLAVES;i++) Probe(i); //Negotiate once at power-up
+
+    while(1)
+    {
+        TA0CCR0 = PERIOD; //Looping period with VLO
+        LPM3;       //Wait in low power mode
+        //Timeout. Exchange a pattern with every slave at its own speed
+        Good = 1;
+        for (s=0;s<NSLAVES;s++)
+        {
+            for (i=0;i<NBYTES;i++) TxData[i] = i + s;
+            if (!Loopback(s, Divider[s])) Good = 0;
+        }
+        if (Good) P1OUT |= BIT0; //Green
+        else P4OUT |= BIT6; //Red
+        TA0CCR0 = BLINK;
+        LPM3;
+        P1OUT &= ~BIT0;
+        P4OUT &= ~BIT6;
+    }
+}
+#pragma vector=TIMER0_A0_VECTOR
+ __interrupt void TIMER_A0 (void)
+{
+    LPM3_EXIT;
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    uint16_t ie;
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP; // Slave absent or refused; release the bus
+                        UCB0IFG &= ~UCTXIFG0;
+                        Error = 1;
+                        LPM0_EXIT;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28:               // Vector 28: clock low timeout. Reset the module and report the failure
+                        ie = UCB0IE;
+                        UCB0CTLW0 |= UCSWRST;
+                        UCB0CTLW0 &= ~UCSWRST;
+                        UCB0IE = ie;
+                        Error = 1;
+                        LPM0_EXIT;
+                        break;
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
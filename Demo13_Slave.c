@@ -0,0 +1,84 @@
+ /*I2C demo with MSP430FR2355 Launchpad as loopback SLAVE for bus speed negotiation (Demo13_Master.c).
+  Bytes written by the master are stored immediately in the ISR and returned unchanged on the next read, so the
+  master can check a test pattern at each SCL rate. Slave is held in LPM4 between transactions.
+  With FAST defined the slave runs MCLK at 8 MHz; otherwise it uses the 1 MHz default. At 1 MHz the ISR cannot keep
+  up with the faster SCL rates and the slave stretches the clock, which the master detects and avoids.
+  Give each slave its own ADDRESS to try a mixed bus.
+    P1.2  UCB0SDA with 10k pullup
+    P1.3  UCB0SCL with 10k pullup
+ */
+ #include <msp430.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #define ADDRESS 0x77
+ #define NBYTES 16
+ //#define FAST //Uncomment for 8 MHz MCLK
+ volatile uint8_t Data[NBYTES], Count;
+ volatile uint8_t *PData;   // Pointer into the loopback buffer
+
+ int main(void)
+ {
+     WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+     PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+     P1DIR |= BIT0; //Red LED on Launchpad
+     P6DIR |= BIT6; //Green LED on Launchpad
+     P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+     P1OUT &= ~BIT0; //Turn off LEDs
+     P6OUT &= ~BIT6;
+
+#ifdef FAST
+     __bis_SR_register(SCG0); //Disable FLL
+     CSCTL3 |= SELREF__REFOCLK; //FLL reference is REFO
+     CSCTL1 = DCORSEL_3; //DCO range 8 MHz
+     CSCTL2 = FLLD_0 + 243; //DCODIV = (243 + 1) * 32768 Hz = ~8 MHz
+     __delay_cycles(3);
+     __bic_SR_register(SCG0); //Enable FLL
+     while (CSCTL7 & (FLLUNLOCK0 | FLLUNLOCK1)); //Wait for FLL lock
+     CSCTL4 = SELMS__DCOCLKDIV + SELA__REFOCLK;
+#endif
+
+     //Setup I2C
+     UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+     UCB0I2COA0 = ADDRESS | UCOAEN;            // Slave address; enable it
+     UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+
+     UCB0IE |= UCRXIE0 + UCTXIE0 + UCSTTIE;    // Enable receive, transmit and start interrupts
+     __enable_interrupt(); //Enable global interrupts.
+
+     while(1) LPM4; //All work is done in the ISR
+ }
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;         // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             PData = (uint8_t *)Data; //Every transaction starts at the top of the buffer
+                             Count = 0;
+                             break;
+     case USCI_I2C_UCSTPIFG: break;          // Vector 8: STPIFG
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             if (Count < NBYTES) { *PData++ = UCB0RXBUF; Count++; }
+                             else UCB0RXBUF;
+                             break;
+     case USCI_I2C_UCTXIFG0:                 // Vector 26: TXIFG0
+                             if (Count < NBYTES) { UCB0TXBUF = *PData++; Count++; }
+                             else UCB0TXBUF = 0xFF;
+                             break;
+     case USCI_I2C_UCBCNTIFG: break;            // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
@@ -0,0 +1,170 @@
+/* MSP430FR2355 Launchpad as SLAVE that phase-aligns its data preparation with the master's polling loop.
+   The master (Demo14_Master.c) broadcasts a sync message on the general call address at the start of every poll:
+     0x5C  MasterTimeLo MasterTimeHi  PeriodLo PeriodHi
+   MasterTime is the master's VLO tick count at this poll; Period is the number of master ticks to the next poll.
+   The slave timestamps the start condition of each sync with its free running Timer_B0 (VLO/8, measured 1.2 kHz
+   not 1.25 kHz). From two syncs it knows how many of its own ticks correspond to one master tick, which absorbs the
+   VLO mismatch and drift between the boards; the ratio is smoothed with a running average. The next poll is
+   expected at sync time + Period * ratio, and data preparation (PREP ticks, shown by the red LED) is scheduled on
+   TB0CCR1 to finish LEAD ticks before that. The slave then sleeps in LPM3 until the master reads.
+   A read at 0x77 returns 2 bytes: Sample and Age, the slave ticks since Sample was completed (255 = stale).
+   Until two syncs have been seen the slave prepares right after each sync, so the first reads are stale.
+     P1.2 SDA on UCB0
+     P1.3 SCL on UCB0
+*/
+#include <msp430.h>
+#include <stdint.h>
+
+#define SYNC 0x5C
+#define PREP 60 //Preparation time in slave ticks (~50 ms), e.g. sensor warm-up and conversion
+#define LEAD 12 //Finish preparation this many ticks before the expected poll
+volatile uint8_t RxData[5], RxCount, TxData[2], TxCount, NewSync;
+volatile uint8_t *PTxData;
+volatile uint16_t StartTime, SyncTime, ReadyTime;
+uint16_t MasterTime, LastMasterTime, LastSyncTime, Period;
+uint32_t Ratio; //Slave ticks per master tick, Q16
+volatile uint8_t Ready, Preparing; //Ready is set once the first sample exists
+uint8_t Sample, Syncs;
+
+//Slave ticks per master tick measured between the last two syncs, Q16
+uint32_t MeasureRatio(void)
+{
+    uint16_t dm, ds;
+    dm = MasterTime - LastMasterTime;
+    ds = SyncTime - LastSyncTime;
+    if (dm == 0) return Ratio;
+    return ((uint32_t)ds << 16) / dm;
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+    PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+    P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+    P1DIR |= BIT0 + BIT1 + BIT4 + BIT5 + BIT6 + BIT7; //Set these pins to outputs
+    P6DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7; //Set these pins to outputs
+    P1OUT &= ~BIT0; //LEDs off
+    P6OUT &= ~BIT6;
+
+    CSCTL4 = SELA__VLOCLK;  //Set ACLK to VLO at 10 kHz
+    /* MC_2 to count continuously, set to ACLK (VLO) and divide it by 8.
+    (The measured frequency is 1.2 kHz NOT 1.25 kHz.) */
+    TB0CTL |= MC_2 + TBSSEL__ACLK + TBCLR;
+    TB0EX0 |= TBIDEX_7;
+
+    UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+    UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+    UCB0I2COA0 = 0x77 | UCOAEN | UCGCEN;      // Slave address is 0x77; also receive the general call sync
+    UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+    UCB0IE |= UCRXIE0 + UCTXIE0 + UCSTTIE + UCSTPIE; // Enable receive, transmit, start and stop I2C interrupts
+    __enable_interrupt(); //Enable global interrupts.
+
+    TxData[0] = 0;
+    TxData[1] = 0xFF; //Nothing prepared yet
+    Syncs = 0;
+    Preparing = 0;
+    Ready = 0;
+
+    while(1)
+    {
+        LPM3; //Wait for a sync or the preparation timer; VLO keeps running
+        if (NewSync)
+        {
+            NewSync = 0;
+            MasterTime = RxData[1] | (RxData[2] << 8);
+            Period = RxData[3] | (RxData[4] << 8);
+            if (Syncs == 1) Ratio = MeasureRatio(); //First estimate
+            else if (Syncs > 1) Ratio = Ratio - (Ratio >> 3) + (MeasureRatio() >> 3); //Running average over ~8 syncs
+            if (Syncs < 2) Syncs++;
+            LastMasterTime = MasterTime;
+            LastSyncTime = SyncTime;
+            //A preparation still running is abandoned
+            TB0CCTL1 = 0;
+            Preparing = 0;
+            P1OUT &= ~BIT0;
+            //Schedule the start of preparation so it ends LEAD ticks before the next poll
+            if (Syncs > 1) TB0CCR1 = SyncTime + (uint16_t)(((uint32_t)Period * Ratio) >> 16) - PREP - LEAD;
+            if ((Syncs < 2) || ((int16_t)(TB0CCR1 - TB0R) <= 0)) TB0CCR1 = TB0R + 1; //No estimate yet, or already late; prepare now
+            TB0CCTL1 = CCIE;
+        }
+    }
+}
+
+#pragma vector=TIMER0_B1_VECTOR
+ __interrupt void Timer_B1 (void)
+{
+    switch(__even_in_range(TB0IV, TB0IV_TBIFG))
+    {
+        case TB0IV_TBCCR1:
+            if (!Preparing) //Start of preparation
+            {
+                Preparing = 1;
+                P1OUT |= BIT0; //Red LED on while working
+                TB0CCR1 += PREP;
+            }
+            else //Preparation finished; publish the new sample
+            {
+                Preparing = 0;
+                P1OUT &= ~BIT0;
+                TB0CCTL1 = 0; //Nothing more until the next sync
+                Sample++;
+                ReadyTime = TB0R;
+                TxData[0] = Sample;
+                Ready = 1;
+            }
+            break;
+        default: break;
+    }
+}
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint16_t age;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;          // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             StartTime = TB0R; //Timestamp as early as possible
+                             RxCount = 0;
+                             PTxData = (uint8_t *)TxData;
+                             TxCount = 2;
+                             age = StartTime - ReadyTime;
+                             TxData[1] = (!Ready || (age > 254)) ? 0xFF : age;
+                             break;
+     case USCI_I2C_UCSTPIFG:                 // Vector 8: STPIFG
+                             UCB0IFG &= ~UCSTPIFG;
+                             if ((RxCount == 5) && (RxData[0] == SYNC))
+                             {
+                                 SyncTime = StartTime;
+                                 NewSync = 1;
+                                 LPM3_EXIT;
+                             }
+                             break;
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             if (RxCount < 5) RxData[RxCount] = UCB0RXBUF;
+                             else UCB0RXBUF;
+                             if (RxCount < 0xFF) RxCount++; //Saturate so a long write cannot wrap back to 5
+                             break;
+     case USCI_I2C_UCTXIFG0:                 // Vector 26: TXIFG0
+                             if (TxCount)
+                             {
+                                 UCB0TXBUF = *PTxData++;
+                                 TxCount--;
+                             }
+                             else UCB0TXBUF = 0xFF;
+                             break;
+     case USCI_I2C_UCBCNTIFG: break;         // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
@@ -0,0 +1,260 @@
+/*I2C demo program with a scripted transaction engine that runs entirely in the interrupts. Master is an MSP430FR5969
+  Launchpad. A multi-step sensor access is written as an array of steps:
+    OP_START    Arg = address byte (7-bit address << 1 | R/W), START condition
+    OP_RESTART  Arg = address byte, repeated START
+    OP_WRITE    Arg = number of bytes, Buf = data to send
+    OP_READ     Arg = number of bytes, Buf = destination
+    OP_STOP     STOP condition
+    OP_DELAY    Arg = VLO ticks to wait on Timer_A1 (only between a STOP and the next START)
+    OP_END      Script finished
+  Main starts the script and sleeps in LPM0. The eUSCI_B0 and Timer_A1 interrupts walk the steps themselves,
+  issuing the STOP or repeated START for a read while its next-to-last byte is in, and wake main only when the
+  whole script has finished or a NACK aborts it. The example writes a register pointer, reads 4 bytes after a
+  repeated start, writes 2 configuration bytes, waits, then reads a status byte. Slave is Demo6_Slave.c or any
+  slave at 0x77. Green LED: script completed and byte 3 is 0x03. Red LED otherwise.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define PERIOD 20000 //Samping period. 10000 count is approximately 1 second; maximum is 65535
+# define BLINK 500
+# define OP_END 0
+# define OP_START 1
+# define OP_RESTART 2
+# define OP_WRITE 3
+# define OP_READ 4
+# define OP_STOP 5
+# define OP_DELAY 6
+# define W(addr) ((addr) << 1) //Address byte for a write
+# define R(addr) (((addr) << 1) | 1) //Address byte for a read
+# define DONE 1
+# define FAILED 2
+
+typedef struct {
+    uint8_t Op;
+    uint8_t Arg;
+    volatile uint8_t *Buf;
+} Step_t;
+
+volatile uint8_t Reg[] = {0x02}, Config[] = {0x03, 0x80}, Data[4], Status[1];
+//Write register, repeated-start read 4, write config, wait, read status
+const Step_t Script[] = {
+    {OP_START, W(0x77), 0},
+    {OP_WRITE, 1, Reg},
+    {OP_RESTART, R(0x77), 0},
+    {OP_READ, 4, Data},
+    {OP_STOP, 0, 0},
+    {OP_START, W(0x77), 0},
+    {OP_WRITE, 2, Config},
+    {OP_STOP, 0, 0},
+    {OP_DELAY, 20, 0},
+    {OP_START, R(0x77), 0},
+    {OP_READ, 1, Status},
+    {OP_STOP, 0, 0},
+    {OP_END, 0, 0}
+};
+
+const Step_t *PStep; //Step being executed
+volatile uint8_t *PData, Count; //Buffer position within a WRITE or READ
+volatile uint8_t Pending; //OP_STOP or OP_RESTART already issued ahead of the end of a READ
+volatile uint8_t Result;
+
+//Send the address byte of a START or RESTART step
+void Address(const Step_t *s)
+{
+    UCB0I2CSA = s->Arg >> 1;
+    if (s->Arg & 1) UCB0CTLW0 &= ~UCTR; //Receiver
+    else UCB0CTLW0 |= UCTR; //Transmitter
+    UCB0CTLW0 |= UCTXSTT;
+}
+
+//The receiver must request STOP or repeated START while the last byte is still arriving
+void PreIssue(void)
+{
+    const Step_t *next = PStep + 1;
+    if (next->Op == OP_RESTART) Address(next);
+    else UCB0CTLW0 |= UCTXSTP; //Anything else after a READ ends the transaction
+    Pending = (next->Op == OP_RESTART) ? OP_RESTART : OP_STOP;
+}
+
+//Load buffer and count for the WRITE or READ following an address
+void Setup(void)
+{
+    PData = PStep->Buf;
+    Count = PStep->Arg;
+    if ((PStep->Op == OP_READ) && (Count == 1))
+    {
+        while (UCB0CTLW0 & UCTXSTT); //Single byte: wait for the address to be acknowledged
+        PreIssue();
+    }
+}
+
+//Execute steps from PStep until one has to wait for an interrupt. Returns DONE or FAILED when finished, else 0
+uint8_t Run(void)
+{
+    switch (PStep->Op)
+    {
+        case OP_START:
+        case OP_RESTART:
+            Address(PStep);
+            PStep++;
+            Setup();
+            return 0; //Wait for TXIFG0 or RXIFG0
+        case OP_STOP:
+            UCB0CTLW0 |= UCTXSTP;
+            PStep++;
+            return 0; //Wait for STPIFG
+        case OP_DELAY:
+            TA1CCR0 = PStep->Arg;
+            TA1CTL = TASSEL_1 + MC_1 + TACLR; //Count VLO ticks
+            PStep++;
+            return 0; //Wait for Timer_A1
+        case OP_END:
+            return DONE;
+        default:
+            UCB0CTLW0 |= UCTXSTP; //Script error
+            return FAILED;
+    }
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    //Default frequency ~ 10 kHz
+    CSCTL2 |= SELA__VLOCLK;  //Set ACLK to VLO
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+
+    //Enable the timer interrupt, MC_1 to count up to TA0CCR0, Timer A set to ACLK (VLO)
+    TA0CCTL0 |= CCIE;
+    TA0CTL |= MC_1 + TASSEL_1;
+    TA1CCTL0 = CCIE; //Timer A1 runs only for OP_DELAY
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0CTLW0 &= ~UCSWRST; // Clear reset
+
+    UCB0IE |= UCTXIE0 + UCRXIE0 + UCSTPIE + UCNACKIE; //Enable I2C transmit, receive, stop and NACK interrupts
+    __enable_interrupt(); //Enable global interrupts.
+
+    while(1)
+    {
+        TA0CCR0 = PERIOD; //Looping period with VLO
+        LPM3;       //Wait in low power mode
+        //Timeout. Run the whole script with a single wake-up at the end
+        PStep = Script;
+        Pending = 0;
+        Result = 0;
+        __disable_interrupt();
+        Result = Run();
+        while (!Result) //Sleep until the ISRs finish the script
+        {
+            __bis_SR_register(LPM0_bits + GIE);
+            __disable_interrupt();
+        }
+        __enable_interrupt();
+
+        if ((Result == DONE) && (Data[2] == 0x03)) P1OUT |= BIT0; //Green
+        else P4OUT |= BIT6; //Red
+        TA0CCR0 = BLINK;
+        LPM3;
+        P1OUT &= ~BIT0;
+        P4OUT &= ~BIT6;
+    }
+}
+#pragma vector=TIMER0_A0_VECTOR
+ __interrupt void TIMER_A0 (void)
+{
+    LPM3_EXIT;
+}
+
+#pragma vector=TIMER1_A0_VECTOR
+ __interrupt void TIMER_A1 (void)
+{
+    TA1CTL = MC_0; //OP_DELAY elapsed
+    Result = Run();
+    if (Result) LPM0_EXIT;
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG. Abort the script
+                        UCB0CTLW0 |= UCTXSTP;
+                        UCB0IFG &= ~UCTXIFG0;
+                        while (PStep->Op != OP_END) PStep++; //STPIFG then finds the end
+                        Result = FAILED;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8:                // Vector 8: STPIFG. Transaction closed; continue with the next step
+                        if (Result == FAILED) LPM0_EXIT;
+                        else
+                        {
+                            Result = Run();
+                            if (Result) LPM0_EXIT;
+                        }
+                        break;
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        *PData++ = UCB0RXBUF;
+                        Count--;
+                        if (Count == 1) PreIssue(); //STOP or repeated START goes out after the next byte
+                        else if (Count == 0)
+                        {
+                            PStep++; //Step that was pre-issued
+                            if (Pending == OP_RESTART)
+                            {
+                                PStep++;
+                                Setup(); //Data phase after the repeated start
+                            }
+                            else if (PStep->Op == OP_STOP) PStep++; //STPIFG continues the script
+                            Pending = 0;
+                        }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (Count)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PData++; // Load TX buffer
+                                Count--;            // Decrement TX byte counter
+                                break;
+                            }
+                        PStep++; //WRITE finished
+                        if (PStep->Op == OP_WRITE) //Consecutive writes continue in the same transaction
+                            {
+                                Setup();
+                                UCB0TXBUF = *PData++;
+                                Count--;
+                                break;
+                            }
+                        UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                        Result = Run(); //STOP or RESTART
+                        if (Result) LPM0_EXIT;
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
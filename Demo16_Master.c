@@ -0,0 +1,182 @@
+/*I2C demo program to benchmark RAM-resident interrupt handlers at high MCLK. Master is an MSP430FR5969 Launchpad.
+  Above 8 MHz the FRAM needs a wait state, which slows every instruction fetched from it once the FRAM cache misses.
+  With RAM_ISR defined, the I2C ISR (which also does the LPM0 wake-up) and the byte copy loop are placed in .TI.ramfunc; the
+  linker command file loads that section in FRAM and runs it from RAM (load=FRAM, run=RAM, table(BINIT)), and the
+  startup code copies it before main. Without RAM_ISR everything runs from FRAM.
+  At power-up the master runs NRUNS write/read exchanges of 10 bytes with the slave (Demo6_Slave.c or
+  Demo16_Slave.c) at SCL ~400 kHz, first with MCLK = SMCLK = 8 MHz (no wait state), then at 16 MHz (1 wait state).
+  Timer_A1 runs on SMCLK and is read on ISR entry and exit; Bench[] holds the average and worst ISR cycles per
+  data byte for each clock. Cycles exclude the fixed interrupt entry and RETI, about 11 cycles. Build once with and
+  once without RAM_ISR and compare Bench[] in the debugger. The per-byte budget at 400 kHz is 9 SCL periods,
+  180 cycles at 8 MHz. Green LED: benchmark finished. Red LED: a transfer was NACKed.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define RAM_ISR //Comment out to run the handlers from FRAM
+# define NRUNS 100
+# define NBYTES 10
+typedef struct {
+    uint8_t Mhz;
+    uint16_t Average, Max; //ISR cycles per data byte
+} Bench_t;
+
+Bench_t Bench[2];
+volatile uint8_t RxCount, TxCount, RxData[NBYTES], TxData[NBYTES], Nack;
+volatile uint8_t *PRxData, *PTxData;   // Pointers to RX and TX data
+volatile uint32_t IsrCycles; //Accumulated ISR cycles for data bytes
+volatile uint16_t IsrMax;
+uint16_t Run;
+uint8_t i, b;
+
+#ifdef RAM_ISR
+#pragma CODE_SECTION(USCI_B0_ISR, ".TI.ramfunc")
+#pragma CODE_SECTION(Copy, ".TI.ramfunc")
+#endif
+
+//Byte copy used for the TX pattern; in RAM with the ISR when RAM_ISR is set
+void Copy(volatile uint8_t *dst, const volatile uint8_t *src, uint8_t n)
+{
+    while (n--) *dst++ = *src++;
+}
+
+//MCLK = SMCLK = DCO at 8 or 16 MHz. Wait state first when speeding up, removed after slowing down
+void SetClock(uint8_t mhz)
+{
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    if (mhz == 16)
+    {
+        FRCTL0 = FRCTLPW | NWAITS_1; //FRAM needs one wait state above 8 MHz
+        CSCTL1 = DCORSEL + DCOFSEL_4; //16 MHz
+        UCB0CTLW0 |= UCSWRST;
+        UCB0BRW = 40; //~400 kHz
+    }
+    else
+    {
+        CSCTL1 = DCOFSEL_6; //8 MHz
+        FRCTL0 = FRCTLPW | NWAITS_0;
+        UCB0CTLW0 |= UCSWRST;
+        UCB0BRW = 20; //~400 kHz
+    }
+    CSCTL2 = SELA__VLOCLK + SELS__DCOCLK + SELM__DCOCLK;
+    CSCTL3 = DIVA__1 + DIVS__1 + DIVM__1;
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+    UCB0CTLW0 &= ~UCSWRST;
+    UCB0IE |= UCTXIE0 + UCRXIE0 + UCNACKIE; //Cleared by UCSWRST
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    // Configure the eUSCI_B0 module for I2C
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0I2CSA = 0x77; // FR2355 address
+    //Timer A1 free runs on SMCLK as a cycle counter
+    TA1CTL = TASSEL__SMCLK + MC__CONTINUOUS + TACLR;
+    __enable_interrupt(); //Enable global interrupts.
+
+    for (b=0;b<2;b++)
+    {
+        Bench[b].Mhz = b ? 16 : 8;
+        SetClock(Bench[b].Mhz);
+        IsrCycles = 0;
+        IsrMax = 0;
+        Nack = 0;
+        for (Run=0;Run<NRUNS;Run++)
+        {
+            for (i=0;i<NBYTES;i++) RxData[i] = i + 1;
+            Copy(TxData, RxData, NBYTES); //Pattern 1..10
+
+            PTxData = (uint8_t *)TxData;
+            TxCount = NBYTES;
+            UCB0CTLW0 |= UCTR + UCTXSTT; // Set to transmit and start
+            LPM0;    // Remain in LPM0 until all data transmitted
+            while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+
+            UCB0CTLW0 &= ~UCTR; //Set as receiver
+            PRxData = (uint8_t *)RxData;
+            RxCount = NBYTES;
+            UCB0CTLW0 |= UCTXSTT; //Start read
+            LPM0; //Wait for I2C
+            while (UCB0CTLW0 & UCTXSTP);
+        }
+        Bench[b].Average = IsrCycles / (2UL * NRUNS * NBYTES);
+        Bench[b].Max = IsrMax;
+    }
+    if (Nack) P4OUT |= BIT6; //Red
+    else P1OUT |= BIT0; //Green
+    while(1) LPM4; //Results are in Bench[]
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    uint16_t start, cycles;
+    start = TA1R;
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP;
+                        UCB0IFG &= ~UCTXIFG0;
+                        Nack = 1;
+                        LPM0_EXIT;
+                        return;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                                return; //Not a data byte
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+    cycles = TA1R - start;
+    IsrCycles += cycles;
+    if (cycles > IsrMax) IsrMax = cycles;
+}
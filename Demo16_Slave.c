@@ -0,0 +1,123 @@
+ /*I2C demo with MSP430FR2355 Launchpad as SLAVE running its I2C handlers from RAM at high MCLK. Companion of
+  Demo16_Master.c. MCLK = SMCLK = 16 MHz from the FLL, which needs one FRAM wait state. With RAM_ISR defined,
+  USCIB0_ISR and the timer wake-up handler are placed in .TI.ramfunc (load=FRAM, run=RAM, table(BINIT) in the
+  linker command file) and copied to RAM by the startup code; otherwise they run from FRAM.
+  Bytes written by the master are stored directly in TxData and returned on the next read, as in Demo 6.
+  Timer_B0 runs on SMCLK as a cycle counter; IsrCycles and Bytes accumulate the ISR time spent on data bytes, so
+  IsrCycles / Bytes is the average per-byte cost and IsrMax the worst case. Compare builds with and without RAM_ISR.
+  Slave waits in LPM0 so the DCO stays locked for a fast response; the LED blinks from Timer_B0 overflows.
+    P1.2  UCB0SDA with 10k pullup
+    P1.3  UCB0SCL with 10k pullup
+ */
+ #include <msp430.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #define RAM_ISR //Comment out to run the handlers from FRAM
+ #define NBYTES 10
+ volatile uint8_t TxData[]={1,2,3,4,5,6,7,8,9,10}, Count;
+ volatile uint8_t *PData;   // Pointer into TxData
+ volatile uint32_t IsrCycles, Bytes;
+ volatile uint16_t IsrMax;
+ volatile uint8_t Ticks;
+
+#ifdef RAM_ISR
+#pragma CODE_SECTION(USCIB0_ISR, ".TI.ramfunc")
+#pragma CODE_SECTION(Timer_B1, ".TI.ramfunc")
+#endif
+
+ int main(void)
+ {
+     WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+     PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+     P1DIR |= BIT0; //Red LED on Launchpad
+     P6DIR |= BIT6; //Green LED on Launchpad
+     P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+     P1OUT &= ~BIT0; //Turn off LEDs
+     P6OUT &= ~BIT6;
+
+     //MCLK at 16 MHz
+     FRCTL0 = FRCTLPW | NWAITS_1; //FRAM needs one wait state above 8 MHz
+     __bis_SR_register(SCG0); //Disable FLL
+     CSCTL3 |= SELREF__REFOCLK; //FLL reference is REFO
+     CSCTL1 = DCORSEL_5; //DCO range 16 MHz
+     CSCTL2 = FLLD_0 + 487; //DCODIV = (487 + 1) * 32768 Hz = ~16 MHz
+     __delay_cycles(3);
+     __bic_SR_register(SCG0); //Enable FLL
+     while (CSCTL7 & (FLLUNLOCK0 | FLLUNLOCK1)); //Wait for FLL lock
+     CSCTL4 = SELMS__DCOCLKDIV + SELA__REFOCLK;
+
+     //Timer B0 free runs on SMCLK; overflow every 4 ms paces the LED
+     TB0CTL = TBSSEL__SMCLK + MC__CONTINUOUS + TBCLR + TBIE;
+
+     //Setup I2C
+     UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+     UCB0I2COA0 = 0x77 | UCOAEN;               // Slave address is 0x77; enable it
+     UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+
+     UCB0IE |= UCRXIE0 + UCTXIE0 + UCSTTIE;    // Enable receive, transmit and start interrupts
+     __enable_interrupt(); //Enable global interrupts.
+
+     while(1)
+     {
+         LPM0; //Woken about twice a second by Timer_B0
+         if(TxData[2]==0x03) P6OUT ^= BIT6; //Green
+         else P1OUT ^= BIT0; //Red
+     }
+ }
+
+#pragma vector=TIMER0_B1_VECTOR
+ __interrupt void Timer_B1 (void)
+{
+    switch(__even_in_range(TB0IV, TB0IV_TBIFG))
+    {
+        case TB0IV_TBIFG:
+            if (++Ticks == 128) //~0.5 s
+            {
+                Ticks = 0;
+                LPM0_EXIT;
+            }
+            break;
+        default: break;
+    }
+}
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint16_t start, cycles;
+   start = TB0R;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;         // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             PData = (uint8_t *)TxData;
+                             Count = 0;
+                             return; //Not a data byte
+     case USCI_I2C_UCSTPIFG: break;          // Vector 8: STPIFG
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             if (Count < NBYTES) { *PData++ = UCB0RXBUF; Count++; }
+                             else UCB0RXBUF;
+                             break;
+     case USCI_I2C_UCTXIFG0:                 // Vector 26: TXIFG0
+                             if (Count < NBYTES) { UCB0TXBUF = *PData++; Count++; }
+                             else UCB0TXBUF = 0xFF;
+                             break;
+     case USCI_I2C_UCBCNTIFG: break;            // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+   cycles = TB0R - start;
+   IsrCycles += cycles;
+   Bytes++;
+   if (cycles > IsrMax) IsrMax = cycles;
+ }
@@ -0,0 +1,273 @@
+/* MSP430FR2355 Launchpad as slave on I2C bus, built from cooperative tasks with a single sleep point.
+   Same commands as Demo 7 (master is Demo7_Master.c): 0x01 0x02 0x03 halts the green LED loop and latches the red
+   LED, 0x04 0x05 0x06 restarts it. Button S1 (P4.1) toggles between the two states locally as well.
+   Each activity is a protothread: a function that keeps its place in a local continuation (Lc) and returns to
+   the scheduler whenever it has to wait, so the tasks share one stack and run concurrently:
+     I2cTask     waits for messages from the I2C ISR (SPSC queue as in Demo 7) and applies the commands
+     LedTask     blinks the green LED while running
+     ButtonTask  waits for a press on S1, debounces it on the timer and toggles running
+   Task locals that must survive a wait are static. The ISRs only record events and exit LPM; the main loop runs
+   every task once and then sleeps in the deepest mode they allow: LPM3 when any task waits on the clock (VLO
+   timer), otherwise LPM4 with the timer stopped. I2C address match and the button wake the slave from LPM4.
+   Timer_B0 counts continuously and is the clock of the tasks: the scheduler reads Now from it once per pass and
+   sets CCR0 to the earliest task deadline, so the CPU wakes only then and not on every tick.
+     P1.2 SDA on UCB0
+     P1.3 SCL on UCB0
+     P4.1 Button S1
+*/
+#include <msp430.h>
+#include <stdint.h>
+
+#define MSGLEN 3 //Longest message kept; longer writes are truncated and marked by Len > MSGLEN
+#define QSIZE 4  //Number of slots, power of 2. One slot is always free for the ISR to fill
+#define TICK 12 //Timer counts of VLO/8 (1.2 kHz) per task tick, ~10 ms
+#define DEBOUNCE 3 //Task ticks
+
+//Protothread with its local continuation and an optional deadline
+typedef struct {
+    uint16_t Lc; //Line to resume at, 0 = beginning
+    uint16_t Wake; //Deadline in timer counts
+    uint8_t Timed; //Waiting for Wake
+} Pt_t;
+
+#define PT_BEGIN(pt) switch ((pt)->Lc) { case 0:
+#define PT_END(pt) } (pt)->Lc = 0; return
+#define PT_WAIT_UNTIL(pt, cond) (pt)->Lc = __LINE__; case __LINE__: if (!(cond)) return
+#define PT_SLEEP(pt, ticks) (pt)->Wake = Now + (ticks) * TICK; (pt)->Timed = 1; \
+    PT_WAIT_UNTIL(pt, (int16_t)(Now - (pt)->Wake) >= 0); (pt)->Timed = 0
+
+typedef struct {
+    uint8_t Len; //Bytes received in the transaction, including any beyond MSGLEN
+    uint8_t Data[MSGLEN];
+} Msg_t;
+
+volatile Msg_t Queue[QSIZE];
+volatile uint8_t QHead, QTail; //QHead written only by the ISR, QTail only by main
+volatile uint16_t QOverflow; //Messages lost because the queue was full
+uint16_t Now; //Timer_B0 count at the start of the current scheduler pass
+volatile uint8_t Pending; //Set by every ISR that may have made a task ready
+volatile uint8_t Pressed; //Button edge seen, cleared by ButtonTask
+uint8_t Running;
+Pt_t PtI2c, PtLed, PtButton;
+Msg_t Msg;
+
+//Copy the oldest message out of the queue. Returns 0 if empty
+uint8_t Pop(Msg_t *m)
+{
+    uint8_t i;
+    if (QTail == QHead) return 0;
+    m->Len = Queue[QTail].Len;
+    for (i=0;i<MSGLEN;i++) m->Data[i] = Queue[QTail].Data[i];
+    QTail = (QTail + 1) & (QSIZE - 1); //Hand the slot back to the ISR
+    return 1;
+}
+
+void SetRunning(uint8_t run)
+{
+    Running = run;
+    if (run) P1OUT &= ~BIT0; //Clear red LED
+    else
+    {
+        P1OUT |= BIT0; //Red LED on
+        P6OUT &= ~BIT6;
+    }
+}
+
+void I2cTask(Pt_t *pt)
+{
+    PT_BEGIN(pt);
+    while (1)
+    {
+        PT_WAIT_UNTIL(pt, Pop(&Msg));
+        if (Msg.Len != 3) continue; //Only 3-byte commands are valid
+        if ((Msg.Data[0] == 1) && (Msg.Data[1] == 2) && (Msg.Data[2] == 3)) SetRunning(0);
+        else if ((Msg.Data[0] == 4) && (Msg.Data[1] == 5) && (Msg.Data[2] == 6)) SetRunning(1);
+    }
+    PT_END(pt);
+}
+
+void LedTask(Pt_t *pt)
+{
+    PT_BEGIN(pt);
+    while (1)
+    {
+        PT_WAIT_UNTIL(pt, Running); //No clock needed while halted
+        PT_SLEEP(pt, 92); //Looping period, ~0.9 s
+        if (!Running) continue;
+        P6OUT |= BIT6; //Flash green LED
+        PT_SLEEP(pt, 8);
+        P6OUT &= ~BIT6; //LED off
+    }
+    PT_END(pt);
+}
+
+void ButtonTask(Pt_t *pt)
+{
+    PT_BEGIN(pt);
+    while (1)
+    {
+        PT_WAIT_UNTIL(pt, Pressed);
+        PT_SLEEP(pt, DEBOUNCE); //Let the contacts settle
+        if (!(P4IN & BIT1)) SetRunning(!Running); //Still pressed
+        Pressed = 0;
+        P4IFG &= ~BIT1; //Drop bounces seen meanwhile
+        P4IE |= BIT1;
+    }
+    PT_END(pt);
+}
+
+//Timer_B0 runs on the VLO, asynchronous to MCLK; read until two reads agree
+uint16_t TimerNow(void)
+{
+    uint16_t t;
+    do t = TB0R; while (t != TB0R);
+    return t;
+}
+
+//Earliest deadline of the timed tasks. Returns 0 if no task waits on the clock
+uint8_t Deadline(uint16_t *wake)
+{
+    Pt_t *t[3];
+    uint8_t i, n = 0;
+    t[0] = &PtI2c;
+    t[1] = &PtLed;
+    t[2] = &PtButton;
+    for (i=0;i<3;i++)
+    {
+        if (!t[i]->Timed) continue;
+        if (!n || ((int16_t)(t[i]->Wake - *wake) < 0)) *wake = t[i]->Wake;
+        n = 1;
+    }
+    return n;
+}
+
+void main(void) {
+
+    uint16_t wake;
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+    PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+    P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+    P1DIR |= BIT0 + BIT1 + BIT4 + BIT5 + BIT6 + BIT7; //Set these pins to outputs
+    P6DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7; //Set these pins to outputs
+    P1OUT &= ~BIT0; //LEDs off
+    P6OUT &= ~BIT6;
+    P4REN |= BIT1; //Button S1 with pullup, interrupt on the falling edge
+    P4OUT |= BIT1;
+    P4IES |= BIT1;
+    P4IFG &= ~BIT1;
+    P4IE |= BIT1;
+
+    CSCTL4 = SELA__VLOCLK;  //Set ACLK to VLO at 10 kHz
+    /* Continuous mode on ACLK (VLO) divided by 8; CCR0 is set to the next deadline.
+    (The measured frequency is 1.2 kHz NOT 1.25 kHz.) Started when a task waits on the clock. */
+    TB0CTL = TBSSEL__ACLK + TBCLR;
+    TB0EX0 |= TBIDEX_7;
+    TB0CCTL0 = CCIE; //Enable the Timer B interrupt
+
+    UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+    UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+    UCB0I2COA0 = 0x77 | UCOAEN;               // Slave address is 0x77; enable it
+    UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+    UCB0IE |= UCRXIE0 + UCSTTIE + UCSTPIE;    // Enable receive, start and stop I2C interrupts
+
+    QHead = 0;
+    QTail = 0;
+    QOverflow = 0;
+    SetRunning(1);
+    __enable_interrupt(); //Enable global interrupts.
+
+    //Scheduler: run every task, then sleep once in the deepest mode they allow
+    while(1)
+    {
+        Pending = 0; //Events from here on are seen by the check below
+        Now = TimerNow();
+        I2cTask(&PtI2c);
+        LedTask(&PtLed);
+        ButtonTask(&PtButton);
+
+        __disable_interrupt();
+        if (Pending) //An ISR fired while the tasks ran; run them again
+        {
+            __enable_interrupt();
+            continue;
+        }
+        if (Deadline(&wake))
+        {
+            TB0CCR0 = wake;
+            TB0CTL |= MC__CONTINUOUS; //Timer keeps running across waits so Now stays continuous
+            if ((int16_t)(wake - TimerNow()) <= 1) //Due, or too close for the compare to catch
+            {
+                __enable_interrupt();
+                continue;
+            }
+            __bis_SR_register(LPM3_bits + GIE); //VLO needed for the deadline
+        }
+        else
+        {
+            TB0CTL &= ~MC_3; //Nothing waits on the clock
+            __bis_SR_register(LPM4_bits + GIE); //Only I2C or the button can wake
+        }
+    }
+}
+
+#pragma vector=TIMER0_B0_VECTOR //This vector name is in header file
+ __interrupt void Timer_B (void)
+{
+    Pending = 1; //CCR0 reached the earliest deadline
+    LPM3_EXIT;
+}
+
+#pragma vector=PORT4_VECTOR
+ __interrupt void Port_4 (void)
+{
+    P4IFG &= ~BIT1;
+    P4IE &= ~BIT1; //ButtonTask re-enables after debouncing
+    Pressed = 1;
+    Pending = 1;
+    LPM4_EXIT;
+}
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint8_t next;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;         // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             Queue[QHead].Len = 0; //Start filling the free slot
+                             break;
+     case USCI_I2C_UCSTPIFG:                 // Vector 8: STPIFG
+                             UCB0IFG &= ~UCSTPIFG;
+                             if (Queue[QHead].Len == 0) break; //Nothing was written
+                             next = (QHead + 1) & (QSIZE - 1);
+                             if (next == QTail) QOverflow++; //Queue full; slot is reused for the next message
+                             else
+                             {
+                                 QHead = next; //Publish the message to I2cTask
+                                 Pending = 1;
+                                 LPM4_EXIT;
+                             }
+                             break;
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+     /* Bytes beyond MSGLEN are read and counted but not stored. */
+                             next = Queue[QHead].Len;
+                             if (next < MSGLEN) Queue[QHead].Data[next] = UCB0RXBUF;
+                             else UCB0RXBUF;
+                             if (next < 0xFF) Queue[QHead].Len = next + 1;
+                             break;
+     case USCI_I2C_UCTXIFG0: break;            // Vector 26: TXIFG0
+     case USCI_I2C_UCBCNTIFG: break;         // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
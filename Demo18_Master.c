@@ -0,0 +1,211 @@
+/*  Pushbutton commands to the Demo 7 slave with debounce, queueing and batching. This is the MASTER code on
+    MSP430FR5969 Launchpad; slave is Demo7_Slave.c or Demo17_Slave.c.
+    The first edge on P1.1 disables the pin interrupt and starts a DEBOUNCE on Timer_A1 (VLO); the button is read
+    once the contacts have settled, and only a settled press toggles the wanted slave state and queues a command
+    (0x01 0x02 0x03 stop, 0x04 0x05 0x06 start). Release is debounced the same way, so bounces never queue anything.
+    The port and timer ISRs fill a lock-free queue (as in Demo7_Slave.c), so presses during a transfer are kept.
+    Main drains the queue into a batch, where a command cancels a pending opposite one (stop + start = nothing),
+    and sends whatever is left in a single I2C write. With stop and start alternating at most one command remains.
+    A NACKed batch is kept and merged with later presses. Main sleeps in LPM4, or LPM3 while debouncing.
+    Green LED flashes for start, red for stop. Presses, Sent and Cancelled count the commands.
+    P1.1  Button S2
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define DEBOUNCE 200 //VLO ticks, ~20 ms
+# define QSIZE 8 //Power of 2
+# define MAXCMD 4 //Commands in one batch
+# define CMD_STOP 1
+# define CMD_START 2
+
+volatile uint8_t TxCount, Nack, Busy; //Busy while main waits in LPM0 for a transfer
+volatile uint8_t *PTxData;   // Pointer to TX data
+volatile uint8_t TxData[3 * MAXCMD];
+const uint8_t Msg1[]={1,2,3}, Msg2[]={4,5,6};
+volatile uint8_t Queue[QSIZE], QHead, QTail; //QHead written only by the ISRs, QTail only by main
+volatile uint8_t Debouncing, Down, Wanted; //Button state, ISRs only
+volatile uint16_t Presses, QOverflow;
+uint8_t Batch[MAXCMD], NBatch;
+uint16_t Sent, Cancelled;
+uint8_t i, n;
+
+//Add a command to the batch; an opposite pending command cancels it
+void Merge(uint8_t cmd)
+{
+    if (NBatch && (Batch[NBatch-1] != cmd))
+    {
+        NBatch--; //Stop followed by start (or start by stop) leaves the slave as it was
+        Cancelled += 2;
+    }
+    else if (NBatch < MAXCMD) Batch[NBatch++] = cmd;
+}
+
+//Send the whole batch in one write. Returns 0 if the slave did not acknowledge
+uint8_t SendBatch(void)
+{
+    const uint8_t *msg;
+    uint8_t *p = (uint8_t *)TxData;
+    for (n=0;n<NBatch;n++)
+    {
+        msg = (Batch[n] == CMD_STOP) ? Msg1 : Msg2;
+        for(i=0;i<3;i++) *p++ = msg[i];
+    }
+    Nack = 0;
+    Busy = 1;
+    PTxData = (uint8_t *)TxData; //Set pointer to start of TX array
+    TxCount = 3 * NBatch;
+    UCB0CTLW0 |= UCTXSTT; // Set to transmit and start
+    LPM0;    // Remain in LPM0 until all data transmitted
+    while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+    Busy = 0;
+    return !Nack;
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT = BIT1; // Pull-up resistor on P1.1
+    P1REN = BIT1; // Select pull-up mode for P1.1
+    P1IES = BIT1; // P1.1 Hi/Lo edge
+    P1IFG = 0;    // Clear all P1 interrupt flags
+    P1IE = BIT1;  // P1.1 interrupt enabled
+    P1OUT &= ~BIT0; //green LED off
+
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    //Default frequency ~ 10 kHz
+    CSCTL2 |= SELA__VLOCLK;  //Set ACLK to VLO
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+    TA1CCR0 = DEBOUNCE;
+    TA1CCTL0 = CCIE; //Timer A1 runs only while debouncing
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCTR + UCSYNC + UCMODE_3; //Select SMCLK, master, transmitter, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0I2CSA = 0x77; // FR2355 address
+    UCB0CTLW0 &= ~UCSWRST; // Clear reset
+
+    UCB0IE |= UCTXIE0 + UCNACKIE; //Enable I2C transmission and NACK interrupts
+    Wanted = CMD_START; //Slave loop runs after reset; the first press stops it
+    __enable_interrupt(); //Enable global interrupts.
+
+    while(1)
+    {
+        //Check the queue with interrupts off so a command cannot slip in before sleeping
+        __disable_interrupt();
+        if (QTail != QHead) __enable_interrupt();
+        else if (Debouncing) __bis_SR_register(LPM3_bits + GIE); //VLO keeps the debounce timer going
+        else __bis_SR_register(LPM4_bits + GIE); //Wait for pushbutton interrupt
+
+        while (QTail != QHead) //Take every queued press, including those made during the last transfer
+        {
+            Merge(Queue[QTail]);
+            QTail = (QTail + 1) & (QSIZE - 1);
+        }
+        if (!NBatch) continue; //Everything cancelled out
+        if (Batch[NBatch-1] == CMD_STOP) P4OUT |= BIT6; //Red LED on
+        else P1OUT |= BIT0; //Green LED on
+        if (SendBatch())
+        {
+            Sent += NBatch;
+            NBatch = 0;
+        }
+        __delay_cycles(10000); //Presses meanwhile are queued by the ISRs
+        P1OUT &= ~BIT0; //LEDs off
+        P4OUT &= ~BIT6;
+    }
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP;
+                        UCB0IFG &= ~UCTXIFG0;
+                        Nack = 1;
+                        LPM0_EXIT;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;        // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22: break;         // Vector 22: RXIFG0
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
+
+#pragma vector=PORT1_VECTOR
+__interrupt void Port_1(void)
+{
+  P1IFG &= ~BIT1;  // Clear P1.1 IFG
+  P1IE &= ~BIT1; //Ignore bounces until the timer samples the pin
+  Debouncing = 1;
+  TA1CTL = TASSEL_1 + MC_1 + TACLR; //Count VLO ticks
+  __bic_SR_register_on_exit(OSCOFF); //LPM4 becomes LPM3 so the VLO runs
+}
+
+#pragma vector=TIMER1_A0_VECTOR
+ __interrupt void TIMER_A1 (void)
+{
+    uint8_t next, pressed;
+    TA1CTL = MC_0;
+    pressed = !(P1IN & BIT1);
+    if (pressed && !Down) //Settled press
+    {
+        Presses++;
+        Wanted = (Wanted == CMD_START) ? CMD_STOP : CMD_START;
+        next = (QHead + 1) & (QSIZE - 1);
+        if (next == QTail) QOverflow++;
+        else
+        {
+            Queue[QHead] = Wanted;
+            QHead = next;
+        }
+    }
+    Down = pressed;
+    if (pressed) P1IES &= ~BIT1; //Next look for the release
+    else P1IES |= BIT1; //Next look for a press
+    P1IFG &= ~BIT1; //Changing the edge can set the flag
+    if ((!(P1IN & BIT1)) != pressed) TA1CTL = TASSEL_1 + MC_1 + TACLR; //Changed meanwhile; sample again
+    else
+    {
+        P1IE |= BIT1;
+        Debouncing = 0;
+    }
+    if (!Busy) LPM3_EXIT; //Main sends the command or goes back to LPM4; after a transfer it checks the queue itself
+}
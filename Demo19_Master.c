@@ -0,0 +1,191 @@
+/*I2C demo program for 10-bit slave addressing and its cost. Master is an MSP430FR5969 Launchpad, slave is
+  Demo19_Slave.c on an MSP430FR2355 Launchpad, which answers at 0x77 in 7-bit mode or 0x2A7 in 10-bit mode.
+  With UCSLA10 set the master sends a 10-bit address as two bytes, 11110xx0 followed by the low 8 bits. A read
+  needs the full address to be written first, so the eUSCI sends both address bytes with W, a repeated START and
+  then 11110xx1 by itself; the slave remembers that it was addressed and switches to transmit. The register read
+  used here (write register pointer, repeated START, read) looks the same on the bus.
+  At power-up the master runs NRUNS transactions of each kind in 7-bit mode, switches the slave and itself to
+  10-bit, and repeats them:
+    Write  START, address, register 0, 4 data bytes, STOP
+    Read   START, address, register 0, repeated START, address, 4 data bytes, STOP
+  Timer_A1 on SMCLK (1 MHz) times each transaction from UCTXSTT to the end of the STOP. Bench[0] holds the
+  average cycles in 7-bit mode, Bench[1] in 10-bit mode, and Overhead the difference per transaction.
+  At 100 kHz one byte on the bus is 90 us, so expect about one extra byte on a write and two on a read.
+  Green LED: all data read back matched. Red LED: mismatch or NACK.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define ADDR7 0x77
+# define ADDR10 0x2A7
+# define REG_CTRL 15 //Slave register selecting its addressing mode
+# define MODE7 0x07
+# define MODE10 0x0A
+# define NRUNS 50
+typedef struct {
+    uint16_t Write, Read; //Average SMCLK cycles per transaction
+} Bench_t;
+
+Bench_t Bench[2], Overhead;
+volatile uint8_t RxCount, TxCount, RxData[4], TxData[5], Nack, ReadAfter;
+volatile uint8_t *PRxData, *PTxData;   // Pointers to RX and TX data
+uint32_t WriteSum, ReadSum;
+uint16_t Run, Start;
+uint8_t i, m, Errors;
+
+//Select 7-bit or 10-bit slave addressing. UCSLA10 can only change in reset
+void SetMode(uint8_t ten)
+{
+    UCB0CTLW0 |= UCSWRST;
+    if (ten)
+    {
+        UCB0CTLW0 |= UCSLA10;
+        UCB0I2CSA = ADDR10;
+    }
+    else
+    {
+        UCB0CTLW0 &= ~UCSLA10;
+        UCB0I2CSA = ADDR7;
+    }
+    UCB0CTLW0 &= ~UCSWRST;
+    UCB0IE |= UCTXIE0 + UCRXIE0 + UCNACKIE; //Cleared by UCSWRST
+}
+
+//Write count bytes of TxData; with read set, follow with a repeated start and read 4 bytes
+void Transfer(uint8_t count, uint8_t read)
+{
+    PTxData = (uint8_t *)TxData;
+    TxCount = count;
+    PRxData = (uint8_t *)RxData;
+    RxCount = 4;
+    ReadAfter = read;
+    UCB0CTLW0 |= UCTR + UCTXSTT; // Set to transmit and start
+    LPM0;    // Remain in LPM0 until the transaction is over
+    while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    //Timer A1 free runs on SMCLK to time the transactions
+    TA1CTL = TASSEL__SMCLK + MC__CONTINUOUS + TACLR;
+    __enable_interrupt(); //Enable global interrupts.
+    Errors = 0;
+
+    for (m=0;m<2;m++)
+    {
+        SetMode(m);
+        WriteSum = 0;
+        ReadSum = 0;
+        for (Run=0;Run<NRUNS;Run++)
+        {
+            TxData[0] = 0; //Register pointer
+            for (i=0;i<4;i++) TxData[i+1] = Run + i;
+            Start = TA1R;
+            Transfer(5, 0);
+            WriteSum += (uint16_t)(TA1R - Start);
+
+            Start = TA1R;
+            Transfer(1, 1);
+            ReadSum += (uint16_t)(TA1R - Start);
+            for (i=0;i<4;i++) if (RxData[i] != TxData[i+1]) Errors++;
+        }
+        Bench[m].Write = WriteSum / NRUNS;
+        Bench[m].Read = ReadSum / NRUNS;
+        if (!m) //Move the slave to 10-bit mode; it applies the change after the STOP
+        {
+            TxData[0] = REG_CTRL;
+            TxData[1] = MODE10;
+            Transfer(2, 0);
+            __delay_cycles(1000);
+        }
+    }
+    Overhead.Write = Bench[1].Write - Bench[0].Write;
+    Overhead.Read = Bench[1].Read - Bench[0].Read;
+
+    //Leave the slave in 7-bit mode for the other demos
+    TxData[0] = REG_CTRL;
+    TxData[1] = MODE7;
+    Transfer(2, 0);
+
+    if (Errors || Nack) P4OUT |= BIT6; //Red
+    else P1OUT |= BIT0; //Green
+    while(1) LPM4; //Results are in Bench[] and Overhead
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP;
+                        UCB0IFG &= ~UCTXIFG0;
+                        Nack = 1;
+                        LPM0_EXIT;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else if (ReadAfter)
+                            {
+                                ReadAfter = 0;
+                                UCB0CTLW0 &= ~UCTR; //Receiver
+                                UCB0CTLW0 |= UCTXSTT; //Repeated start; in 10-bit mode the eUSCI adds the address write
+                                UCB0IFG &= ~UCTXIFG0;
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
@@ -0,0 +1,113 @@
+ /*I2C demo with MSP430FR2355 Launchpad as SLAVE with 7-bit or 10-bit own address. Companion of Demo19_Master.c.
+  The slave has 16 registers. The first byte of a write sets the register pointer and the following bytes are
+  stored from there on; a read returns registers from the pointer on. Register 15 (REG_CTRL) selects the
+  addressing mode: 0x07 for 7-bit address 0x77, 0x0A for 10-bit address 0x2A7. UCA10 and the own address can only
+  change while the eUSCI is in reset, so the ISR only flags the request on the STOP and main applies it.
+  In 10-bit mode the eUSCI matches both address bytes itself. A read (11110xx1 after a repeated START) is only
+  acknowledged if the slave was addressed for write just before, which the eUSCI also tracks.
+  Red LED: 10-bit mode. Green LED: 7-bit mode.
+    P1.2  UCB0SDA with 10k pullup
+    P1.3  UCB0SCL with 10k pullup
+ */
+ #include <msp430.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #define ADDR7 0x77
+ #define ADDR10 0x2A7
+ #define NREGS 16
+ #define REG_CTRL 15
+ #define MODE7 0x07
+ #define MODE10 0x0A
+ volatile uint8_t Regs[NREGS], Ptr, First, ModeChange;
+
+ //Own address in 7-bit or 10-bit mode; UCA10 can only change in reset
+ void SetMode(uint8_t ten)
+ {
+     UCB0CTLW0 |= UCSWRST;
+     if (ten)
+     {
+         UCB0CTLW0 |= UCA10;
+         UCB0I2COA0 = ADDR10 | UCOAEN;
+         P1OUT |= BIT0; //Red
+         P6OUT &= ~BIT6;
+     }
+     else
+     {
+         UCB0CTLW0 &= ~UCA10;
+         UCB0I2COA0 = ADDR7 | UCOAEN;
+         P6OUT |= BIT6; //Green
+         P1OUT &= ~BIT0;
+     }
+     UCB0CTLW0 &= ~UCSWRST;
+     UCB0IE |= UCRXIE0 + UCTXIE0 + UCSTTIE + UCSTPIE; //Cleared by UCSWRST
+ }
+
+ int main(void)
+ {
+     WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+     PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+     P1DIR |= BIT0; //Red LED on Launchpad
+     P6DIR |= BIT6; //Green LED on Launchpad
+     P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+     P1OUT &= ~BIT0; //Turn off LEDs
+     P6OUT &= ~BIT6;
+
+     //Setup I2C
+     UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+     Regs[REG_CTRL] = MODE7;
+     SetMode(0);
+     __enable_interrupt(); //Enable global interrupts.
+
+     while(1)
+     {
+         LPM4; //Woken only for a mode change
+         ModeChange = 0;
+         SetMode(Regs[REG_CTRL] == MODE10);
+     }
+ }
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;         // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             First = 1; //Next byte written is the register pointer
+                             break;
+     case USCI_I2C_UCSTPIFG:                 // Vector 8: STPIFG
+                             UCB0IFG &= ~UCSTPIFG;
+                             if (ModeChange) LPM4_EXIT;
+                             break;
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             if (First)
+                             {
+                                 First = 0;
+                                 Ptr = UCB0RXBUF & (NREGS - 1);
+                             }
+                             else
+                             {
+                                 Regs[Ptr] = UCB0RXBUF;
+                                 if (Ptr == REG_CTRL) ModeChange = 1;
+                                 Ptr = (Ptr + 1) & (NREGS - 1);
+                             }
+                             break;
+     case USCI_I2C_UCTXIFG0:                 // Vector 26: TXIFG0
+                             UCB0TXBUF = Regs[Ptr];
+                             Ptr = (Ptr + 1) & (NREGS - 1);
+                             break;
+     case USCI_I2C_UCBCNTIFG: break;            // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
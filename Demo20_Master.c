@@ -0,0 +1,125 @@
+/*I2C demo program reading eight channels of one slave through eight addresses. Master is an MSP430FR5969
+  Launchpad, slave is Demo20_Slave.c, which answers 0x70 to 0x77 through UCB0ADDMASK and maps each address to a
+  channel. At every timeout of the VLO timer the master reads 2 bytes from each address with a plain read; no
+  register pointer is written first, so every channel costs one transaction instead of a write plus a read.
+  Samples are stored in Sample[] and the top nibble of each must equal its channel number.
+  Green LED: all eight channels answered with the right channel. Red LED: NACK or wrong channel.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define PERIOD 20000 //Samping period. 10000 count is approximately 1 second; maximum is 65535
+# define BLINK 500
+# define BASE 0x70
+# define NCHAN 8
+volatile uint8_t RxCount, RxData[2], Nack;
+volatile uint8_t *PRxData;   // Pointer to RX data
+uint16_t Sample[NCHAN];
+uint8_t c, Errors;
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    //Default frequency ~ 10 kHz
+    CSCTL2 |= SELA__VLOCLK;  //Set ACLK to VLO
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+
+    //Enable the timer interrupt, MC_1 to count up to TA0CCR0, Timer A set to ACLK (VLO)
+    TA0CCTL0 |= CCIE;
+    TA0CTL |= MC_1 + TASSEL_1;
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, receiver, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0CTLW0 &= ~UCSWRST; // Clear reset
+
+    UCB0IE |= UCRXIE0 + UCNACKIE; //Enable I2C receive and NACK interrupts
+    __enable_interrupt(); //Enable global interrupts.
+
+    while(1)
+    {
+        TA0CCR0 = PERIOD; //Looping period with VLO
+        LPM3;       //Wait in low power mode
+        //Timeout. One plain read per channel address
+        Errors = 0;
+        for (c=0;c<NCHAN;c++)
+        {
+            UCB0I2CSA = BASE + c;
+            Nack = 0;
+            PRxData = (uint8_t *)RxData;    // Point to start of RX array
+            RxCount = 2;
+            UCB0CTLW0 |= UCTXSTT; //Start read
+            LPM0; //Wait for I2C
+            while (UCB0CTLW0 & UCTXSTP);
+            Sample[c] = (RxData[0] << 8) | RxData[1];
+            if (Nack || ((Sample[c] >> 12) != c)) Errors++;
+        }
+
+        if (!Errors) P1OUT |= BIT0; //Green
+        else P4OUT |= BIT6; //Red
+        TA0CCR0 = BLINK;
+        LPM3;
+        P1OUT &= ~BIT0;
+        P4OUT &= ~BIT6;
+    }
+}
+#pragma vector=TIMER0_A0_VECTOR
+ __interrupt void TIMER_A0 (void)
+{
+    LPM3_EXIT;
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP;
+                        Nack = 1;
+                        LPM0_EXIT;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24: break;         // Vector 24: TXIFG0
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
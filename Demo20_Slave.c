@@ -0,0 +1,96 @@
+ /*I2C demo with MSP430FR2355 Launchpad as SLAVE answering a range of addresses with UCB0ADDMASK.
+  Own address 0x70 with address mask 0x3F8 makes the eUSCI acknowledge 0x70 to 0x77: bits cleared in the mask are
+  ignored in the address comparison. On the start condition the ISR reads the address actually received from
+  UCB0ADDRX and selects one of eight channels, so each channel is read with a plain read of its own address,
+  without writing a register pointer first. A read returns the 2-byte sample of the channel, high byte first;
+  the top nibble of the sample is the channel number so the master can check the mapping. A write to a channel
+  address sets its step, the amount added to the sample at every Timer_B0 period. Companion of Demo20_Master.c.
+  Green LED toggles when channel 0 is read, red when any other channel is.
+    P1.2  UCB0SDA with 10k pullup
+    P1.3  UCB0SCL with 10k pullup
+ */
+ #include <msp430.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #define BASE 0x70
+ #define NCHAN 8 //Power of 2; channel = address - BASE
+ #define PERIOD 1200 //Timer_B0 period, ~1 s with VLO/8
+ volatile uint16_t Sample[NCHAN];
+ volatile uint8_t Step[NCHAN] = {1,2,3,4,5,6,7,8};
+ volatile uint16_t Latched; //Sample being sent, copied at the start so the timer cannot split it
+ volatile uint8_t Chan, Index;
+
+ int main(void)
+ {
+     WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+     PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+     P1DIR |= BIT0; //Red LED on Launchpad
+     P6DIR |= BIT6; //Green LED on Launchpad
+     P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+     P1OUT &= ~BIT0; //Turn off LEDs
+     P6OUT &= ~BIT6;
+
+     CSCTL4 = SELA__VLOCLK;  //Set ACLK to VLO at 10 kHz
+     //Timer B0 updates the samples, VLO/8 (measured 1.2 kHz)
+     TB0CCR0 = PERIOD;
+     TB0CTL |= MC_1 + TBSSEL__ACLK + TBCLR;
+     TB0EX0 |= TBIDEX_7;
+     TB0CCTL0 = CCIE;
+
+     //Setup I2C
+     UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+     UCB0I2COA0 = BASE | UCOAEN;               // Base address 0x70; enable it
+     UCB0ADDMASK = 0x3FF & ~(NCHAN - 1);       // 0x3F8: ignore the low 3 address bits, match 0x70-0x77
+     UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+
+     UCB0IE |= UCRXIE0 + UCTXIE0 + UCSTTIE;    // Enable receive, transmit and start interrupts
+     __enable_interrupt(); //Enable global interrupts.
+
+     while(1) LPM3; //Timer and I2C do all the work
+ }
+
+#pragma vector=TIMER0_B0_VECTOR
+ __interrupt void Timer_B (void)
+{
+    uint8_t n;
+    for (n=0;n<NCHAN;n++) Sample[n] = (Sample[n] + Step[n]) & 0x0FFF;
+}
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;         // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             Chan = UCB0ADDRX & (NCHAN - 1); //Address that matched selects the channel
+                             Latched = Sample[Chan] | ((uint16_t)Chan << 12);
+                             Index = 0;
+                             if (Chan) P1OUT ^= BIT0;
+                             else P6OUT ^= BIT6;
+                             break;
+     case USCI_I2C_UCSTPIFG: break;          // Vector 8: STPIFG
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             Step[Chan] = UCB0RXBUF; //Last byte written wins
+                             break;
+     case USCI_I2C_UCTXIFG0:                 // Vector 26: TXIFG0
+                             if (Index == 0) UCB0TXBUF = Latched >> 8;
+                             else if (Index == 1) UCB0TXBUF = (uint8_t)Latched;
+                             else UCB0TXBUF = 0xFF;
+                             Index++;
+                             break;
+     case USCI_I2C_UCBCNTIFG: break;            // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
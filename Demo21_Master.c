@@ -0,0 +1,199 @@
+/*I2C demo program comparing the energy of a master transfer with the CPU in LPM0 and in LPM3. Master is an
+  MSP430FR5969 Launchpad, slave is Demo6_Slave.c. Each timeout of the VLO timer runs the Demo 6 exchange (write 10
+  bytes, read them back) in one of two modes, alternating so one capture holds both:
+    Mode 0  SMCLK = DCO 1 MHz, CPU in LPM0 during the transfer. The DCO stays on for the whole transfer.
+    Mode 1  SMCLK = MODOSC/4 (~1.25 MHz), CPU in LPM3 during the transfer. SMCLK is off in LPM3, but the eUSCI
+            requests it while it is busy (SMCLKREQEN in CSCTL6, set at reset), so only MODOSC runs between the
+            interrupts and the DCO is off. MCLK still comes from the DCO and restarts for each ISR.
+  UCB0BRW is set so both modes give ~100 kHz. The VLO is too slow to clock the bus from ACLK directly.
+  P1.3 is high from the start of the write to the end of the read and P1.4 shows the mode (high = LPM3). To compare
+  the modes, capture the supply current with EnergyTrace or a scope on a current shunt, integrate it over the P1.3
+  window for each mode and divide by the number of transactions to get uA*s per transaction. Ticks[] and
+  Wakeups[] accumulate the transfer time (VLO ticks, ~100 us) and the CPU wake-ups per mode; divide by Runs[] for
+  the averages that go with the trace.
+  Green LED: 3rd byte came back as 0x03. Red LED otherwise. LEDs flash only after the P1.3 window.
+    P1.3  Transfer window marker
+    P1.4  Mode marker
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define PERIOD 20000 //Samping period. 10000 count is approximately 1 second; maximum is 65535
+# define BLINK 500
+# define ALTERNATE //Comment out to stay in Mode 1
+volatile uint8_t RxCount, TxCount, RxData[10], Busy;
+volatile uint8_t *PRxData, *PTxData;   // Pointers to RX and TX data
+volatile uint8_t TxData[]={1,2,3,4,5,6,7,8,9,10};
+volatile uint16_t IsrCount; //Interrupts taken during the current exchange
+uint32_t Ticks[2], Wakeups[2];
+uint16_t Runs[2], Start;
+uint8_t Mode, Control_Byte;
+
+//Clock SMCLK and the bus for the given mode
+void SetMode(uint8_t mode)
+{
+    UCB0CTLW0 |= UCSWRST;
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    CSCTL1 = DCOFSEL_0; //DCO at 1 MHz in both modes; the reset default is 8 MHz divided by 8
+    if (mode)
+    {
+        CSCTL2 = SELA__VLOCLK + SELS__MODOSC + SELM__DCOCLK;
+        CSCTL3 = DIVA__1 + DIVS__4 + DIVM__1;
+        CSCTL6 |= SMCLKREQEN + MODCLKREQEN; //Modules may request SMCLK and MODCLK in LPM3
+        UCB0BRW = 12; //~1.25 MHz / 12 = 104 kHz
+        P1OUT |= BIT4;
+    }
+    else
+    {
+        CSCTL2 = SELA__VLOCLK + SELS__DCOCLK + SELM__DCOCLK;
+        CSCTL3 = DIVA__1 + DIVS__1 + DIVM__1;
+        UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+        P1OUT &= ~BIT4;
+    }
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+    UCB0CTLW0 &= ~UCSWRST;
+    UCB0IE |= UCTXIE0 + UCRXIE0; //Cleared by UCSWRST
+}
+
+//Sleep until the ISR clears Busy, in LPM0 or LPM3 depending on the mode
+void Wait(void)
+{
+    __disable_interrupt();
+    while (Busy)
+    {
+        if (Mode) __bis_SR_register(LPM3_bits + GIE);
+        else __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~(BIT0 + BIT3 + BIT4); //green LED and markers off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    //Enable the timer interrupt, MC_1 to count up to TA0CCR0, Timer A set to ACLK (VLO)
+    TA0CCTL0 |= CCIE;
+    TA0CTL |= MC_1 + TASSEL_1;
+    TA1CTL = TASSEL_1 + MC__CONTINUOUS + TACLR; //VLO ticks for the transfer time
+
+    // Configure the eUSCI_B0 module for I2C
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0I2CSA = 0x77; // FR2355 address
+    Mode = 1;
+    SetMode(Mode);
+    __enable_interrupt(); //Enable global interrupts.
+
+    while(1)
+    {
+        TA0CCR0 = PERIOD; //Looping period with VLO
+        LPM3;       //Wait in low power mode
+        //Timeout
+#ifdef ALTERNATE
+        Mode ^= 1;
+        SetMode(Mode);
+#endif
+        Control_Byte ^= BIT0;
+        TxData[2] = Control_Byte ? 0x07 : 0x03; //Toggle the 3rd byte
+
+        P1OUT |= BIT3; //Transfer window starts
+        Start = TA1R;
+        IsrCount = 0;
+        PTxData = (uint8_t *)TxData; //Set pointer to start of TX array
+        TxCount = 10; //Send all 10 bytes to slave
+        Busy = 1;
+        UCB0CTLW0 |= UCTR + UCTXSTT; // Set to transmit and start
+        Wait();
+        while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+
+        UCB0CTLW0 &= ~UCTR; //Set as receiver
+        PRxData = (uint8_t *)RxData;    // Point to start of RX array
+        RxCount = 10; //Read entire data register from slave
+        Busy = 1;
+        UCB0CTLW0 |= UCTXSTT; //Start read
+        Wait();
+        while (UCB0CTLW0 & UCTXSTP);
+        P1OUT &= ~BIT3; //Transfer window ends
+
+        Ticks[Mode] += (uint16_t)(TA1R - Start);
+        Wakeups[Mode] += IsrCount;
+        Runs[Mode]++;
+
+        //Test 3rd byte of received data. Blink one of the LEDs
+        if (RxData[2] == 0x03) P1OUT |= BIT0; //Green
+        else P4OUT |= BIT6; //Red
+        TA0CCR0 = BLINK;
+        LPM3;
+        P1OUT &= ~BIT0;
+        P4OUT &= ~BIT6;
+    }
+}
+#pragma vector=TIMER0_A0_VECTOR
+ __interrupt void TIMER_A0 (void)
+{
+    LPM3_EXIT;
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    IsrCount++;
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4: break;         // Vector 4: NACKIFG
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                Busy = 0;
+                                LPM3_EXIT;             // Exit LPM0 or LPM3
+                            }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                Busy = 0;
+                                LPM3_EXIT;      // Exit LPM0 or LPM3
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
@@ -0,0 +1,342 @@
+ /*I2C demo with MSP430FR2355 Launchpad as SLAVE emulating four sensors at once, for load testing a master.
+  Each entry of the table Tab answers on its own address through UCB0I2COA0..3 and describes a register
+  window, its reset values, the output samples, the data-ready rate and the clock stretching of one device:
+    T_MAP   byte registers; the first byte written is the register pointer, reads and writes auto-increment it
+            always or, as on ST parts, when bit 7 of the pointer is set. A status register can carry a
+            data-ready bit, set at every sample and cleared by reading the last output byte, and an overrun
+            bit, set when a sample arrives before the previous one was read.
+    T_WIDE  16-bit registers sent MSB first (TMP102 style); the pointer stays put, so repeated reads return
+            the same register.
+    T_HOLD  command based with "hold master" conversion (HTU21D style): 0xE3 (temperature) or 0xE5 (humidity)
+            starts a conversion of period ms, and the following read holds SCL low until it ends, then
+            returns MSB, LSB and CRC-8. 0xFE resets the device.
+  Every sample adds step (times the word number) to each 16-bit output word, so the master sees changing data.
+  A nonzero stretch holds SCL for that many REFO ticks at the start of every read, to exercise the master's
+  clock stretching handling; the eUSCI holds SCL by itself while TXBUF has not been written, so the TX
+  interrupt of the device is disabled until Timer_B0 CCR1 expires.
+  Timer_B0 runs continuously on ACLK = REFO at 32768 Hz; CCR0 ticks every ms for the data-ready and conversion
+  timers. The slave sleeps in LPM3 and does all the work in the ISRs.
+  The eUSCI asks for the next byte while the current one is shifted out, so the byte loaded into TXBUF takes
+  effect (pointer increment, data-ready clear, LEDs) only at the next TXIFG, when it moves to the shift
+  register; a byte still in TXBUF at STOP or repeated START was never sent and is dropped. Red LED: access
+  outside a register window. Green LED toggles when the master reads a complete sample.
+    P1.2  UCB0SDA with 10k pullup
+    P1.3  UCB0SCL with 10k pullup
+ */
+ #include <msp430.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #define NSENS 4 //One entry per own address register
+ #define MAPSIZE 96 //Sum of the register windows
+ #define TICK 33 //REFO counts per ms tick
+ #define NONE 0xFF
+ #define T_MAP 0
+ #define T_WIDE 1
+ #define T_HOLD 2
+
+ typedef struct {
+     uint8_t addr;              // 7-bit address; entry n answers on UCB0I2COAn
+     uint8_t type;              // T_MAP, T_WIDE or T_HOLD
+     uint8_t first, count;      // Register window in bytes
+     const uint8_t (*init)[2];  // Reset values as {register, value}
+     uint8_t ninit;
+     uint8_t status, drdy, ovr; // Status register with its data-ready and overrun bits; drdy 0: no status
+     uint8_t data, words;       // First output byte and number of 16-bit output words
+     uint8_t big;               // Output words MSB first
+     uint8_t autoinc;           // Pointer increment: 0 never, 1 always, 0x80 when pointer bit 7 is set
+     uint16_t period;           // ms between samples; T_HOLD: conversion time
+     uint16_t stretch;          // REFO ticks SCL is held at the start of every read, 0 for none
+     uint16_t step;             // Output word increment per sample
+ } Sensor;
+
+ const uint16_t TxIe[NSENS] = {UCTXIE0, UCTXIE1, UCTXIE2, UCTXIE3}; //Not evenly spaced: bit 1, then bits 9, 11, 13
+
+ const uint8_t Lis3dhInit[][2] = {{0x0F, 0x33}, {0x20, 0x07}}; // WHO_AM_I, CTRL_REG1
+ const uint8_t Tmp102Init[][2] = {{0, 0x19}, {2, 0x60}, {3, 0xA0}, {4, 0x4B}, {6, 0x50}}; // 25 C, config, TLOW, THIGH
+ const uint8_t Bmp280Init[][2] = {{0xD0, 0x58}, {0xF7, 0x65}, {0xFA, 0x7E}}; // id, press_msb, temp_msb
+ const uint8_t Htu21dInit[][2] = {{0, 0x66}, {1, 0x4C}, {2, 0x7C}, {3, 0x82}}; // ~21 C, ~50 %RH
+
+ const Sensor Tab[NSENS] = {
+     // addr  type    first count  init            status drdy  ovr  data  words big autoinc period stretch step
+     {0x18, T_MAP,  0x0F, 0x1F, Lis3dhInit, 2, 0x27, 0x08, 0x80, 0x28, 3, 0, 0x80,   10,  0, 0x40},  // LIS3DH accelerometer, 100 Hz
+     {0x48, T_WIDE, 0x00, 8,    Tmp102Init, 5, 0,    0,    0,    0x00, 1, 1, 0,     250,  0, 0x10},  // TMP102 temperature, 4 Hz
+     {0x76, T_MAP,  0xD0, 0x2D, Bmp280Init, 3, 0,    0,    0,    0xF7, 3, 1, 1,      40,  3, 0x100}, // BMP280 pressure, SCL held ~90 us per read
+     {0x40, T_HOLD, 0x00, 4,    Htu21dInit, 4, 0,    0,    0,    0x00, 2, 1, 0,      50,  0, 0x20},  // HTU21D humidity, hold master
+ };
+
+ uint8_t Map[MAPSIZE];             // Register windows of all sensors
+ uint8_t Base[NSENS];              // Start of each window in Map
+ volatile uint8_t Ptr[NSENS];      // Register pointer or last command
+ volatile uint8_t Sel[NSENS];      // T_HOLD: 0 temperature, 1 humidity
+ volatile uint16_t Due[NSENS];     // ms to the next sample
+ volatile uint16_t Conv[NSENS];    // T_HOLD: ms left in the conversion, 0 when idle
+ volatile uint8_t Dev, Index, First;
+ volatile uint8_t Loaded;          // TXBUF holds a byte whose side effects wait until it is shifted out
+ volatile uint8_t Held = NONE;     // Sensor holding SCL until its first byte is ready
+
+ static uint8_t Get(uint8_t d, uint8_t reg) //0xFF outside the register window
+ {
+     uint8_t i = reg - Tab[d].first;
+     return i < Tab[d].count ? Map[Base[d] + i] : 0xFF;
+ }
+
+ static void Put(uint8_t d, uint8_t reg, uint8_t b)
+ {
+     uint8_t i = reg - Tab[d].first;
+     if (i < Tab[d].count) Map[Base[d] + i] = b;
+     else P1OUT |= BIT0;
+ }
+
+ static void Reset(uint8_t d)
+ {
+     uint8_t i;
+     for (i = 0; i < Tab[d].count; i++) Map[Base[d] + i] = 0;
+     for (i = 0; i < Tab[d].ninit; i++) Put(d, Tab[d].init[i][0], Tab[d].init[i][1]);
+     Ptr[d] = 0;
+     Conv[d] = 0;
+     Due[d] = Tab[d].period;
+ }
+
+ //New output words and data-ready flags
+ static void Sample(uint8_t d)
+ {
+     const Sensor *s = &Tab[d];
+     uint8_t w, *p;
+     uint16_t v;
+     for (w = 0; w < s->words; w++)
+     {
+         p = &Map[Base[d] + s->data - s->first + 2 * w];
+         v = s->big ? (p[0] << 8) | p[1] : p[0] | (p[1] << 8);
+         v += s->step * (w + 1);
+         if (s->type == T_HOLD) v = (v & 0xFFFC) | (w ? 0x02 : 0); //Status bits: 1x = humidity
+         if (s->big) { p[0] = v >> 8; p[1] = v; }
+         else { p[0] = v; p[1] = v >> 8; }
+     }
+     if (s->drdy)
+     {
+         p = &Map[Base[d] + s->status - s->first];
+         if (*p & s->drdy) *p |= s->ovr;
+         *p |= s->drdy;
+     }
+ }
+
+ static uint8_t Crc8(uint8_t d, uint8_t reg) //HTU21D: x^8 + x^5 + x^4 + 1, init 0
+ {
+     uint8_t crc = 0, i, k;
+     for (k = 0; k < 2; k++)
+     {
+         crc ^= Get(d, reg + k);
+         for (i = 0; i < 8; i++) crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+     }
+     return crc;
+ }
+
+ static uint8_t Addr(uint8_t d) //Register byte addressed by the pointer
+ {
+     if (Tab[d].type == T_WIDE) return 2 * Ptr[d] + (Index & 1);
+     if (Tab[d].autoinc == 0x80) return Ptr[d] & 0x7F;
+     return Ptr[d];
+ }
+
+ static void Advance(uint8_t d)
+ {
+     if (Tab[d].type != T_MAP) return;
+     if (Tab[d].autoinc == 1) Ptr[d]++;
+     else if (Tab[d].autoinc == 0x80 && (Ptr[d] & 0x80)) Ptr[d] = 0x80 | (Ptr[d] + 1);
+ }
+
+ static uint8_t NextByte(uint8_t d) //Byte for TXBUF, without side effects
+ {
+     if (Tab[d].type == T_HOLD)
+     {
+         if (Index < 2) return Get(d, 2 * Sel[d] + Index);
+         if (Index == 2) return Crc8(d, 2 * Sel[d]);
+         return 0xFF;
+     }
+     return Get(d, Addr(d));
+ }
+
+ static void Sent(uint8_t d) //The byte from NextByte left TXBUF for the shift register
+ {
+     const Sensor *s = &Tab[d];
+     uint8_t reg;
+     if (s->type == T_HOLD)
+     {
+         if (Index == 2) P6OUT ^= BIT6; //Green
+     }
+     else
+     {
+         reg = Addr(d);
+         if ((uint8_t)(reg - s->first) >= s->count) P1OUT |= BIT0; //Red
+         else if (s->drdy && reg == s->data + 2 * s->words - 1)
+         {
+             Map[Base[d] + s->status - s->first] &= ~(s->drdy | s->ovr);
+             P6OUT ^= BIT6;
+         }
+         Advance(d);
+     }
+     Index++;
+ }
+
+ static void Command(uint8_t d, uint8_t c) //T_HOLD
+ {
+     if (c == 0xE3 || c == 0xE5)
+     {
+         Sel[d] = c == 0xE5;
+         Conv[d] = Tab[d].period;
+     }
+     else if (c == 0xFE) Reset(d);
+ }
+
+ static void Release(void) //Load the first byte of a held read; the eUSCI lets SCL go
+ {
+     uint8_t d = Held;
+     Held = NONE;
+     UCB0TXBUF = NextByte(d);
+     Loaded = 1;
+     UCB0IE |= TxIe[d];
+ }
+
+ static void EndRead(void) //Drop the byte the eUSCI fetched but did not send
+ {
+     Loaded = 0;
+ }
+
+ int main(void)
+ {
+     uint8_t d, n = 0;
+     WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+     PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+     P1DIR |= BIT0; //Red LED on Launchpad
+     P6DIR |= BIT6; //Green LED on Launchpad
+     P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+     P1OUT &= ~BIT0; //Turn off LEDs
+     P6OUT &= ~BIT6;
+
+     for (d = 0; d < NSENS; d++)
+     {
+         Base[d] = n;
+         n += Tab[d].count;
+         Reset(d);
+     }
+
+     //ACLK = REFO keeps running in LPM3; Timer B0 counts it continuously, CCR0 is the ms tick
+     CSCTL4 = SELMS__DCOCLKDIV + SELA__REFOCLK;
+     TB0CCR0 = TICK;
+     TB0CCTL0 = CCIE;
+     TB0CTL = TBSSEL__ACLK + MC__CONTINUOUS + TBCLR;
+
+     //Setup I2C
+     UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+     UCB0I2COA0 = Tab[0].addr | UCOAEN;        // One own address per sensor
+     UCB0I2COA1 = Tab[1].addr | UCOAEN;
+     UCB0I2COA2 = Tab[2].addr | UCOAEN;
+     UCB0I2COA3 = Tab[3].addr | UCOAEN;
+     UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+
+     UCB0IE |= UCRXIE0 + UCRXIE1 + UCRXIE2 + UCRXIE3 + UCTXIE0 + UCTXIE1 + UCTXIE2 + UCTXIE3 + UCSTTIE + UCSTPIE;
+     __enable_interrupt(); //Enable global interrupts.
+
+     while(1) LPM3;
+ }
+
+#pragma vector=TIMER0_B0_VECTOR
+ __interrupt void Timer_B0 (void)
+{
+    uint8_t d;
+    TB0CCR0 += TICK;
+    for (d = 0; d < NSENS; d++)
+    {
+        if (Tab[d].type == T_HOLD)
+        {
+            if (Conv[d] && --Conv[d] == 0)
+            {
+                Sample(d);
+                if (Held == d) Release();
+            }
+        }
+        else if (--Due[d] == 0)
+        {
+            Due[d] = Tab[d].period;
+            Sample(d);
+        }
+    }
+}
+
+#pragma vector=TIMER0_B1_VECTOR
+ __interrupt void Timer_B1 (void)
+{
+    switch(__even_in_range(TB0IV, TB0IV_TBIFG))
+    {
+        case TB0IV_TBCCR1: //End of a read stretch
+            TB0CCTL1 = 0;
+            if (Held != NONE) Release();
+            break;
+        default: break;
+    }
+}
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint8_t b;
+   uint16_t t;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;           // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                  // Vector 6: STTIFG, also at a repeated start
+                             EndRead();
+                             b = UCB0ADDRX & 0x7F;
+                             for (Dev = 0; Dev < NSENS - 1 && Tab[Dev].addr != b; Dev++);
+                             Index = 0;
+                             First = 1;
+                             if ((UCB0CTLW0 & UCTR) && (Conv[Dev] || Tab[Dev].stretch))
+                             {
+                                 Held = Dev; //SCL stays low until TXBUF is written
+                                 UCB0IE &= ~TxIe[Dev];
+                                 if (!Conv[Dev])
+                                 {
+                                     do t = TB0R; while (t != TB0R); //Timer runs on ACLK; read until stable
+                                     TB0CCR1 = t + Tab[Dev].stretch;
+                                     TB0CCTL1 = CCIE;
+                                 }
+                             }
+                             break;
+     case USCI_I2C_UCSTPIFG:                  // Vector 8: STPIFG
+                             EndRead();
+                             break;
+     case USCI_I2C_UCRXIFG3:                  // Vector 10: RXIFG3
+     case USCI_I2C_UCRXIFG2:                  // Vector 14: RXIFG2
+     case USCI_I2C_UCRXIFG1:                  // Vector 18: RXIFG1
+     case USCI_I2C_UCRXIFG0:                  // Vector 22: RXIFG0
+                             b = UCB0RXBUF;
+                             if (First)
+                             {
+                                 First = 0;
+                                 if (Tab[Dev].type == T_HOLD) Command(Dev, b);
+                                 else Ptr[Dev] = b;
+                             }
+                             else if (Tab[Dev].type != T_HOLD)
+                             {
+                                 Put(Dev, Addr(Dev), b);
+                                 Advance(Dev);
+                                 Index++;
+                             }
+                             break;
+     case USCI_I2C_UCTXIFG3:                  // Vector 12: TXIFG3
+     case USCI_I2C_UCTXIFG2:                  // Vector 16: TXIFG2
+     case USCI_I2C_UCTXIFG1:                  // Vector 20: TXIFG1
+     case USCI_I2C_UCTXIFG0:                  // Vector 24: TXIFG0
+                             if (Loaded) Sent(Dev); //Previous byte is being shifted out
+                             UCB0TXBUF = NextByte(Dev);
+                             Loaded = 1;
+                             break;
+     case USCI_I2C_UCBCNTIFG: break;          // Vector 26: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;          // Vector 28: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;          // Vector 30: 9th bit
+     default: break;
+   }
+ }
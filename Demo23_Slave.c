@@ -0,0 +1,171 @@
+ /*I2C demo with MSP430FR2355 Launchpad as SLAVE with a register map that survives resets and brownouts.
+  The master writes the register number followed by data bytes, which go to consecutive registers; a read returns
+  the registers from the last register number written. Registers 0..NREGS-1 are read/write; REG_SEQ and REG_SEQ+1
+  return the sequence number of the last commit (low byte first). Other addresses read 0xFF and ignore writes.
+  The ISR only works on the hot copy Reg in SRAM and widens the dirty range [DirtyLo, DirtyHi) when a byte changes,
+  so the bus never waits on FRAM or on the write protection. A STOP after a write that changed something wakes main,
+  which commits the dirty range in one batch before it goes back to LPM3; several writes between two commits are
+  coalesced into one FRAM update.
+  Power-fail safe commit: two banks in information FRAM, each holding a sequence number, the whole map and a CRC-16
+  over both. A commit updates the older bank and writes its CRC last, so a reset in the middle leaves a bank that
+  fails the CRC and the other, complete one is used. The older bank is one commit behind, so the range copied is
+  the dirty range plus the range of the previous commit. At reset the valid bank with the higher sequence number is
+  loaded into Reg, so the slave answers with the master's configuration without it being sent again.
+  Red LED: no valid bank at reset, defaults loaded. Green LED toggles at every commit.
+    P1.2  UCB0SDA with 10k pullup
+    P1.3  UCB0SCL with 10k pullup
+ */
+ #include <msp430.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #define NREGS 32
+ #define REG_SEQ 0xF0
+
+ typedef struct {
+     uint16_t seq;
+     uint8_t reg[NREGS];
+     uint16_t crc; //Over seq and reg; written last
+ } Bank;
+
+#pragma LOCATION(Banks, 0x1800) //Information FRAM
+#pragma NOINIT(Banks)
+ volatile Bank Banks[2];
+
+ const uint8_t Default[NREGS] = {1,2,3,4,5,6,7,8,9,10};
+ volatile uint8_t Reg[NREGS];            // Hot copy used by the ISR
+ volatile uint8_t DirtyLo = NREGS, DirtyHi; // Changed since the last commit; empty when DirtyHi == 0
+ volatile uint8_t Ptr, Index, First;
+ uint8_t StaleLo, StaleHi;                // Written by the last commit, so missing from the other bank
+ uint8_t Active;                          // Bank holding the newest image
+ uint16_t Commits;
+
+ uint16_t Crc16(const volatile uint8_t *p, uint16_t n)
+ {
+     CRCINIRES = 0xFFFF;
+     while (n--) CRCDI_L = *p++;
+     return CRCINIRES;
+ }
+
+ uint8_t BankValid(uint8_t i)
+ {
+     return Crc16((const volatile uint8_t *)&Banks[i], sizeof(uint16_t) + NREGS) == Banks[i].crc;
+ }
+
+ //Write the dirty range to the older bank and make it the active one
+ void Commit(void)
+ {
+     volatile Bank *b = &Banks[Active ^ 1];
+     uint8_t dlo, dhi, lo, hi, i;
+     __disable_interrupt();
+     dlo = DirtyLo;
+     dhi = DirtyHi;
+     DirtyLo = NREGS;
+     DirtyHi = 0;
+     __enable_interrupt(); //Bytes the ISR changes from here on are dirty for the next commit
+     lo = (StaleLo < dlo) ? StaleLo : dlo; //This bank also misses what the last commit wrote to the other one
+     hi = (StaleHi > dhi) ? StaleHi : dhi;
+     SYSCFG0 = FRWPPW | PFWP; //Unlock information FRAM only
+     b->seq = Banks[Active].seq + 1; //A torn commit fails the CRC
+     for (i = lo; i < hi; i++) b->reg[i] = Reg[i];
+     b->crc = Crc16((const volatile uint8_t *)b, sizeof(uint16_t) + NREGS);
+     SYSCFG0 = FRWPPW | PFWP | DFWP; //Lock FRAM again
+     Active ^= 1;
+     StaleLo = dlo; //Only this commit's bytes are missing from the other bank now
+     StaleHi = dhi;
+     Commits++;
+     P6OUT ^= BIT6; //Green
+ }
+
+ int main(void)
+ {
+     uint8_t i, v0, v1;
+     WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+     PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+     P1DIR |= BIT0; //Red LED on Launchpad
+     P6DIR |= BIT6; //Green LED on Launchpad
+     P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+     P1OUT &= ~BIT0; //Turn off LEDs
+     P6OUT &= ~BIT6;
+
+     //Restore the newest complete image
+     v0 = BankValid(0);
+     v1 = BankValid(1);
+     if (v0 && v1) Active = (int16_t)(Banks[1].seq - Banks[0].seq) > 0;
+     else Active = v1;
+     if (v0 || v1)
+         for (i = 0; i < NREGS; i++) Reg[i] = Banks[Active].reg[i];
+     else
+     {
+         for (i = 0; i < NREGS; i++) Reg[i] = Default[i];
+         DirtyLo = 0; //Store the defaults
+         DirtyHi = NREGS;
+         P1OUT |= BIT0; //Red
+     }
+     StaleLo = 0; //Contents of the other bank are unknown
+     StaleHi = NREGS;
+
+     //Setup I2C
+     UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+     UCB0I2COA0 = 0x77 | UCOAEN;               // Slave address is 0x77; enable it
+     UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+
+     UCB0IE |= UCRXIE0 + UCTXIE0 + UCSTTIE + UCSTPIE; // Enable receive, transmit, start and stop interrupts
+     __enable_interrupt(); //Enable global interrupts.
+
+     while(1)
+     {
+         __disable_interrupt();
+         if (DirtyHi) //Flush before sleeping
+         {
+             __enable_interrupt();
+             Commit();
+         }
+         else __bis_SR_register(LPM3_bits + GIE); //Woken by a STOP that left dirty registers
+     }
+ }
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint8_t b;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;           // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                  // Vector 6: STTIFG
+                             Index = Ptr;
+                             First = 1;
+                             break;
+     case USCI_I2C_UCSTPIFG:                  // Vector 8: STPIFG
+                             if (DirtyHi) LPM3_EXIT;
+                             break;
+     case USCI_I2C_UCRXIFG0:                  // Vector 22: RXIFG0
+                             b = UCB0RXBUF;
+                             if (First) //Register number
+                             {
+                                 First = 0;
+                                 Ptr = Index = b;
+                             }
+                             else
+                             {
+                                 if (Index < NREGS && Reg[Index] != b)
+                                 {
+                                     Reg[Index] = b;
+                                     if (Index < DirtyLo) DirtyLo = Index;
+                                     if (Index >= DirtyHi) DirtyHi = Index + 1;
+                                 }
+                                 Index++;
+                             }
+                             break;
+     case USCI_I2C_UCTXIFG0:                  // Vector 24: TXIFG0
+                             if (Index < NREGS) UCB0TXBUF = Reg[Index];
+                             else if (Index == REG_SEQ) UCB0TXBUF = (uint8_t)Banks[Active].seq;
+                             else if (Index == REG_SEQ + 1) UCB0TXBUF = Banks[Active].seq >> 8;
+                             else UCB0TXBUF = 0xFF;
+                             Index++;
+                             break;
+     default: break;
+   }
+ }
@@ -0,0 +1,306 @@
+/*I2C demo program for a second, software I2C bus on spare GPIOs next to the hardware one. Master is an
+  MSP430FR5969 Launchpad, which has a single eUSCI_B; bus 0 is UCB0 and bus 1 is bit-banged on P3.5/P3.6.
+  Both buses are used through the same call,
+    Transfer(bus, addr, tx, ntx, rx, nrx)   START, addr+W, ntx bytes, repeated START, addr+R, nrx bytes, STOP
+  (either part may be empty) which sleeps in LPM0 until the transaction is over and returns 1 on a NACK.
+  The software bus is paced by Timer_A1: CCR0 interrupts every half SCL period, and the ISR performs one bus
+  phase per interrupt, so the CPU sleeps between phases instead of spinning in __delay_cycles. The lines are
+  open drain: PxOUT stays 0 and a line is driven low by setting its PxDIR bit, released by clearing it.
+  At the end of every high half the ISR checks that SCL really is high; if the slave stretches the clock, the
+  phase is retried one half period later. Data is sampled at the end of the high half, after the rise time.
+  MCLK = SMCLK = 16 MHz, so a half period at 100 kHz is HALF = 80 cycles, and a phase must fit into it with the
+  interrupt entry and exit; if it does not, the bus simply runs slower.
+  At power-up the master runs NRUNS write/read exchanges on each bus with the slave (Demo23_Slave.c or any
+  slave with a register pointer at 0x77): register 0 and 4 data bytes, then 4 bytes read back.
+  Timer_B0 runs on SMCLK; Bench[bus] is the average transaction time in cycles, and the software ISR is timed
+  on entry and exit: Soft.Tick is the average ISR cycles per phase, Soft.Bit per clocked bit including START and
+  STOP, and Soft.Stretch counts retried phases. Cycles exclude the fixed interrupt entry and RETI, about 11 cycles.
+  Green LED: all data read back matched on both buses. Red LED: mismatch or NACK.
+    P1.6  UCB0SDA with 10k pullup (bus 0)
+    P1.7  UCB0SCL with 10k pullup
+    P3.6  Software SDA with 10k pullup (bus 1)
+    P3.5  Software SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define ADDR 0x77
+# define NRUNS 50
+# define HALF 80 //SMCLK cycles per half SCL period: 16 MHz / 80 / 2 = 100 kHz
+# define SCL BIT5
+# define SDA BIT6
+# define SCL_LOW P3DIR |= SCL
+# define SCL_REL P3DIR &= ~SCL
+# define SDA_LOW P3DIR |= SDA
+# define SDA_REL P3DIR &= ~SDA
+//Software bus states; each runs in one Timer_A1 interrupt
+# define B_START 0   //SCL high: SDA low
+# define B_LOW 1     //End of a high half: sample, SCL low, next SDA
+# define B_HIGH 2    //Release SCL
+# define B_RESTART 3 //SCL low and SDA released: release SCL
+# define B_STOP 4    //SCL and SDA low: release SCL
+# define B_END 5     //SCL high: release SDA
+typedef struct {
+    uint16_t Tick, Bit; //Average ISR cycles per phase and per bit
+    uint16_t Stretch; //Phases retried while the slave held SCL low
+} Soft_t;
+
+uint16_t Bench[2];
+Soft_t Soft;
+volatile uint8_t RxCount, TxCount, Nack, ReadAfter;
+volatile uint8_t *PRxData;
+const uint8_t *PTxData;
+volatile uint8_t State, Bit, Shift, Rx, Reading, Addr;
+volatile uint32_t IsrCycles, Ticks, Bits;
+volatile uint16_t Stretch;
+uint8_t TxData[5], RxData[4];
+uint32_t Sum;
+uint16_t Run, Start;
+uint8_t i, bus, Errors;
+
+//Same transaction on UCB0 (bus 0) or on the software bus (bus 1). Returns 1 if the slave NACKed
+uint8_t Transfer(uint8_t bus, uint8_t addr, const uint8_t *tx, uint8_t ntx, uint8_t *rx, uint8_t nrx)
+{
+    PTxData = tx;
+    TxCount = ntx;
+    PRxData = rx;
+    RxCount = nrx;
+    Nack = 0;
+    if (bus == 0)
+    {
+        UCB0I2CSA = addr;
+        ReadAfter = ntx && nrx;
+        if (ntx) UCB0CTLW0 |= UCTR + UCTXSTT; // Write first; the TX ISR turns around to the read
+        else
+        {
+            UCB0CTLW0 &= ~UCTR;
+            UCB0CTLW0 |= UCTXSTT;
+            if (nrx == 1) //Single byte: STOP as soon as the address is out
+            {
+                while (UCB0CTLW0 & UCTXSTT);
+                UCB0CTLW0 |= UCTXSTP;
+            }
+        }
+        LPM0;    // Remain in LPM0 until the transaction is over
+        while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+    }
+    else
+    {
+        Addr = addr;
+        Reading = !ntx;
+        Shift = (addr << 1) | Reading;
+        Rx = 0;
+        Bit = 0;
+        State = B_START;
+        TA1CCR0 = HALF - 1;
+        TA1CTL = TASSEL__SMCLK + MC__UP + TACLR;
+        LPM0;    // The timer ISR wakes main after the STOP
+    }
+    return Nack;
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P3OUT &= ~(SCL + SDA); //Software bus: both lines released, low when driven
+    P3DIR &= ~(SCL + SDA);
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    //MCLK = SMCLK = 16 MHz
+    FRCTL0 = FRCTLPW | NWAITS_1; //FRAM needs one wait state above 8 MHz
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    CSCTL1 = DCORSEL + DCOFSEL_4; //16 MHz
+    CSCTL2 = SELA__VLOCLK + SELS__DCOCLK + SELM__DCOCLK;
+    CSCTL3 = DIVA__1 + DIVS__1 + DIVM__1;
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0BRW = 160;  //Divide SMCLK by 160 to get 100 kHz
+    UCB0CTLW0 &= ~UCSWRST;
+    UCB0IE |= UCTXIE0 + UCRXIE0 + UCNACKIE;
+    //Timer A1 paces the software bus; Timer B0 free runs on SMCLK for timing
+    TA1CCTL0 = CCIE;
+    TB0CTL = TBSSEL__SMCLK + MC__CONTINUOUS + TBCLR;
+    __enable_interrupt(); //Enable global interrupts.
+    Errors = 0;
+
+    for (bus=0;bus<2;bus++)
+    {
+        Sum = 0;
+        for (Run=0;Run<NRUNS;Run++)
+        {
+            TxData[0] = 0; //Register pointer
+            for (i=0;i<4;i++) TxData[i+1] = Run + i + bus;
+            Start = TB0R;
+            if (Transfer(bus, ADDR, TxData, 5, RxData, 4)) Errors++;
+            Sum += (uint16_t)(TB0R - Start);
+            for (i=0;i<4;i++) if (RxData[i] != TxData[i+1]) Errors++;
+        }
+        Bench[bus] = Sum / NRUNS;
+    }
+    Soft.Tick = IsrCycles / Ticks;
+    Soft.Bit = IsrCycles / Bits;
+    Soft.Stretch = Stretch;
+
+    if (Errors) P4OUT |= BIT6; //Red
+    else P1OUT |= BIT0; //Green
+    while(1) LPM4; //Results are in Bench[] and Soft
+}
+
+//Software bus: one phase per half SCL period
+#pragma vector = TIMER1_A0_VECTOR
+__interrupt void TIMER1_A0(void)
+{
+    uint16_t start;
+    uint8_t in;
+    start = TB0R;
+    switch (State)
+    {
+        case B_START:
+                        if (!(P3IN & SCL)) { Stretch++; break; }
+                        SDA_LOW; //START: SDA falls while SCL is high
+                        Bits++;
+                        State = B_LOW;
+                        break;
+        case B_LOW:
+                        if (!(P3IN & SCL)) { Stretch++; break; } //Slave holds SCL low: extend the high half
+                        in = P3IN & SDA;
+                        if (Bit == 9) //ACK slot just clocked; the byte is complete
+                        {
+                            Bit = 0;
+                            if (Rx)
+                            {
+                                *PRxData++ = Shift;
+                                if (--RxCount == 0) State = B_STOP;
+                            }
+                            else if (in) { Nack = 1; State = B_STOP; }
+                            else if (Reading) Rx = 1; //Address+R acknowledged, data follows
+                            else if (TxCount) { Shift = *PTxData++; TxCount--; }
+                            else if (RxCount)
+                            {
+                                Reading = 1;
+                                Shift = (Addr << 1) | 1;
+                                State = B_RESTART;
+                            }
+                            else State = B_STOP;
+                        }
+                        else if (Bit && Rx) Shift = (Shift << 1) | (in != 0);
+                        SCL_LOW;
+                        if (State == B_STOP) SDA_LOW;
+                        else if (State == B_RESTART) SDA_REL;
+                        else
+                        {
+                            if (Bit < 8)
+                            {
+                                if (Rx || (Shift & 0x80)) SDA_REL;
+                                else SDA_LOW;
+                                if (!Rx) Shift <<= 1;
+                            }
+                            else if (Rx && RxCount > 1) SDA_LOW; //ACK all but the last byte read
+                            else SDA_REL;
+                            Bit++;
+                            Bits++;
+                            State = B_HIGH;
+                        }
+                        break;
+        case B_HIGH:
+                        SCL_REL;
+                        State = B_LOW;
+                        break;
+        case B_RESTART:
+                        SCL_REL;
+                        Rx = 0;
+                        State = B_START;
+                        break;
+        case B_STOP:
+                        SCL_REL;
+                        State = B_END;
+                        break;
+        case B_END:
+                        if (!(P3IN & SCL)) { Stretch++; break; }
+                        SDA_REL; //STOP: SDA rises while SCL is high
+                        Bits++;
+                        TA1CTL = TASSEL__SMCLK; //Stop the timer
+                        LPM0_EXIT;
+                        break;
+        default: break;
+    }
+    Ticks++;
+    IsrCycles += (uint16_t)(TB0R - start);
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP;
+                        UCB0IFG &= ~UCTXIFG0;
+                        Nack = 1;
+                        LPM0_EXIT;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else if (ReadAfter)
+                            {
+                                ReadAfter = 0;
+                                UCB0CTLW0 &= ~UCTR; //Receiver
+                                UCB0CTLW0 |= UCTXSTT; //Repeated start
+                                UCB0IFG &= ~UCTXIFG0;
+                                if (RxCount == 1) //Single byte: STOP as soon as the address is out
+                                {
+                                    while (UCB0CTLW0 & UCTXSTT);
+                                    UCB0CTLW0 |= UCTXSTP;
+                                }
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
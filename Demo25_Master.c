@@ -0,0 +1,174 @@
+/*I2C demo program for a polling master that sleeps in LPM3.5 between polls. Master is an MSP430FR5969 Launchpad,
+  slave is Demo1_Slave.c or any slave that returns a byte at 0x77 on an MSP430FR2355 Launchpad.
+  In LPM3.5 the core regulator is off and only the RTC runs, on the 32768 Hz crystal of the Launchpad (PJ.4/PJ.5);
+  the RTC_B prescaler interrupt RT1PS wakes the master every 2 s. Every wake-up is a reset: RAM and the peripheral
+  registers are lost, the I/O pins keep their state while LOCKLPM5 is set, and SYSRSTIV reads SYSRSTIV_LPM5WU.
+  Everything that must survive lives in FRAM (State, #pragma PERSISTENT): poll and NACK counts, the last byte read,
+  the LED outputs and the latency figures. Fast resume after a wake-up:
+    _system_pre_init  stops the watchdog, starts Timer_A1 on SMCLK for the latency measurement and skips the C
+                      auto-initialization of RAM, which the resume path does not use
+    Resume            re-enables the crystal before the pins are unlocked so the RTC keeps its clock, restores the
+                      LED outputs and the I2C pins, clears LOCKLPM5 and configures UCB0 in one write; the clock
+                      system stays at its reset default, MCLK = SMCLK = 1 MHz
+  The power-up path (ColdStart) does the full initialization of the other demos, polls once, then starts the
+  crystal and the RTC, which takes up to a second.
+  Poll reads one byte by polling the eUSCI flags, then the master goes back to LPM3.5. The latency is counted in
+  SMCLK cycles from _system_pre_init to the first falling edge of SCL (P1IN still shows the pin with UCB0 selected):
+  State.Last, Min, Max and Sum / Wakes on wake-ups, State.Cold on the last power-up. The wake-up time of the
+  hardware from LPM3.5 to the first instruction (datasheet tWAKE-UP LPM3.5) comes on top of these figures.
+  Green LED: last byte read was 0x03. Red LED: other data or NACK. The LEDs stay latched through LPM3.5.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+    PJ.4/PJ.5  32768 Hz crystal
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define ADDR 0x77
+typedef struct {
+    uint16_t Wakes, Polls, Nacks, Colds;
+    uint8_t Data; //Last byte read
+    uint8_t Out1, Out4; //LED outputs restored before the pins are unlocked
+    uint16_t Last, Min, Max; //SMCLK cycles from reset to the first SCL edge after a wake-up
+    uint32_t Sum;
+    uint16_t Cold; //Same on the last power-up, full initialization
+} State_t;
+
+#pragma PERSISTENT(State)
+State_t State = {0, 0, 0, 0, 0, 0, 0, 0, 0xFFFF, 0, 0, 0};
+#pragma NOINIT(Wake)
+uint16_t Wake; //Reset reason, read before the C startup code runs
+
+//Runs before the C startup code. Returning 0 skips the initialization of RAM variables
+int _system_pre_init(void)
+{
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+    TA1CTL = TASSEL__SMCLK + MC__CONTINUOUS + TACLR; //Counts from here to the first SCL edge
+    Wake = SYSRSTIV;
+    return Wake != SYSRSTIV_LPM5WU;
+}
+
+//Read one byte from the slave; returns the SMCLK count at the first SCL edge
+uint16_t Poll(void)
+{
+    uint16_t t;
+    UCB0CTLW0 &= ~UCTR;
+    UCB0CTLW0 |= UCTXSTT; //START and address
+    while (P1IN & BIT7); //SCL falls at the end of the START
+    t = TA1R;
+    while (UCB0CTLW0 & UCTXSTT); //Address sent
+    UCB0CTLW0 |= UCTXSTP; //Single byte: STOP after it
+    while (!(UCB0IFG & (UCRXIFG0 + UCNACKIFG)));
+    if (UCB0IFG & UCNACKIFG)
+    {
+        UCB0IFG &= ~UCNACKIFG;
+        State.Nacks++;
+        State.Data = 0;
+    }
+    else State.Data = UCB0RXBUF;
+    while (UCB0CTLW0 & UCTXSTP); //Ensure stop condition got sent
+    State.Polls++;
+    //LEDs are latched through LPM3.5; keep a copy for the next resume
+    if (State.Data == 0x03) { P1OUT |= BIT0; P4OUT &= ~BIT6; } //Green
+    else { P1OUT &= ~BIT0; P4OUT |= BIT6; } //Red
+    State.Out1 = P1OUT;
+    State.Out4 = P4OUT;
+    return t;
+}
+
+//Minimal restart after an RTC wake-up from LPM3.5
+void Resume(void)
+{
+    PJSEL0 |= BIT4 + BIT5; //Crystal pins, before LOCKLPM5 is cleared so the RTC clock does not stop
+    CSCTL0_H = CSKEY_H;
+    CSCTL4 &= ~LFXTOFF;
+    CSCTL0_H = 0;
+    P1OUT = State.Out1; //Same levels as latched in the pins
+    P4OUT = State.Out4;
+    P1DIR = BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P4DIR = 0xFF;
+    P1SEL1 = BIT6 + BIT7; //I2C on UCB0
+    PM5CTL0 &= ~LOCKLPM5;
+    UCB0CTLW0 = UCSWRST + UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Reset state, one write
+    UCB0BRW = 10;  //~100 kHz
+    UCB0I2CSA = ADDR;
+    UCB0CTLW0 &= ~UCSWRST;
+    RTCPS1CTL &= ~RT1PSIFG; //The wake-up event
+}
+
+//Full initialization at power-up or any other reset
+void ColdStart(void)
+{
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+    PJSEL0 |= BIT4 + BIT5; //Crystal pins
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    CSCTL1 = DCOFSEL_6; //8 MHz
+    CSCTL2 = SELA__LFXTCLK + SELS__DCOCLK + SELM__DCOCLK;
+    CSCTL3 = DIVA__1 + DIVS__8 + DIVM__8; //MCLK = SMCLK = 1 MHz, as after a wake-up
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0I2CSA = ADDR;
+    UCB0CTLW0 &= ~UCSWRST;
+
+    State.Cold = Poll();
+    State.Colds++;
+
+    //Start the crystal; it can take most of a second
+    CSCTL0_H = CSKEY_H;
+    CSCTL4 &= ~LFXTOFF;
+    do
+    {
+        CSCTL5 &= ~LFXTOFFG;
+        SFRIFG1 &= ~OFIFG;
+    } while (SFRIFG1 & OFIFG);
+    CSCTL0_H = 0;
+    //RTC_B in calendar mode; RT1PS divides 32768 / 256 = 128 Hz by 256 for an interrupt every 2 s
+    RTCCTL01 = RTCHOLD;
+    RTCPS1CTL = RT1IP_7 + RT1PSIE;
+    RTCCTL01 &= ~RTCHOLD;
+}
+
+void main(void) {
+
+    uint16_t t;
+    if (Wake == SYSRSTIV_LPM5WU)
+    {
+        Resume();
+        t = Poll();
+        State.Wakes++;
+        State.Last = t;
+        State.Sum += t;
+        if (t < State.Min) State.Min = t;
+        if (t > State.Max) State.Max = t;
+    }
+    else ColdStart();
+
+    //LPM3.5: regulator off, only the RTC runs. The next RT1PS interrupt restarts the master at reset
+    UCB0CTLW0 |= UCSWRST;
+    PMMCTL0_H = PMMPW_H;
+    PMMCTL0_L |= PMMREGOFF;
+    PMMCTL0_L &= ~SVSHE; //Supply supervisor off in LPMx.5
+    PMMCTL0_H = 0;
+    __bis_SR_register(LPM4_bits + GIE); //The RTC keeps the crystal running, so this is LPM3.5
+    while(1); //Not reached
+}
+
+//Only runs if an RTC flag is still set when interrupts are enabled
+#pragma vector = RTC_VECTOR
+__interrupt void RTC_ISR(void)
+{
+    switch(__even_in_range(RTCIV, RTCIV_RT1PSIFG))
+    {
+        case RTCIV_RT1PSIFG: break;
+        default: break;
+    }
+}
@@ -0,0 +1,234 @@
+/*I2C demo program for polling several slaves at intervals that adapt to how often their data changes. Master is
+  an MSP430FR5969 Launchpad. Each entry of the table Slaves gives an address, the register to read from, the number
+  of bytes and the bounds of the poll interval in VLO counts (10000 is about 1 s). A poll writes the register,
+  sends a repeated START and reads Len bytes, which are compared with the previous payload of that slave:
+    changed    the interval drops to Min at once, so a slave that starts moving is followed closely
+    unchanged  after QUIET unchanged polls in a row the interval doubles, up to Max
+    NACK       the interval doubles at once, up to Max, so a missing slave costs little bus time
+  A static slave settles at Max and costs one transaction per Max, while a fast-changing one stays at Min.
+  Timer_A0 runs continuously on the VLO; each slave has its own due time and CCR0 is set to the earliest one,
+  so the master sleeps in LPM3 until some slave is due. Sched[] holds the current interval, poll, change and NACK
+  counts of each slave; Total is the number of polls made and Fixed the number a fixed PERIOD for every slave
+  would have made over the same time.
+  The default table matches Demo22_Slave.c (TMP102 and LIS3DH emulation) and Demo23_Slave.c on the same bus.
+  Green LED toggles when a payload changes. Red LED: a slave NACKed.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define PERIOD 20000 //Fixed polling period of the other demos, for comparison
+# define NSLAVES 3 //Number of entries in the slave table
+# define MAXLEN 6 //Longest payload
+# define QUIET 2 //Unchanged polls before the interval is doubled
+typedef struct {
+    uint8_t Addr, Reg, Len;
+    uint16_t Min, Max; //Poll interval bounds in VLO counts, Max <= 32767
+} Slave_t;
+typedef struct {
+    uint16_t Interval, Due; //VLO counts
+    uint8_t Quiet; //Unchanged polls in a row
+    uint16_t Polls, Changes, Nacks;
+} Sched_t;
+
+const Slave_t Slaves[NSLAVES] = {
+    {0x77, 0x00, 4, 2000, 30000}, //Demo23_Slave: configuration registers, change only when written
+    {0x48, 0x00, 2, 1000, 30000}, //Demo22_Slave TMP102: temperature, new value every 250 ms
+    {0x18, 0xA8, 6,  500, 20000}, //Demo22_Slave LIS3DH: X, Y, Z from OUT_X_L with auto-increment
+};
+Sched_t Sched[NSLAVES];
+uint8_t Last[NSLAVES][MAXLEN];
+volatile uint8_t RxCount, TxCount, RxData[MAXLEN], TxData[1], Nack, ReadAfter;
+volatile uint8_t *PRxData, *PTxData;   // Pointers to RX and TX data
+uint32_t Elapsed; //VLO counts since power-up
+uint16_t Total, Fixed, Now, Then, Next;
+uint8_t i, j, Changed;
+
+//Timer_A0 runs on the VLO, asynchronous to MCLK; read until two reads agree
+uint16_t TimerNow(void)
+{
+    uint16_t t;
+    do t = TA0R; while (t != TA0R);
+    return t;
+}
+
+//Write the register pointer, then read Len bytes after a repeated start
+void Poll(uint8_t n)
+{
+    UCB0I2CSA = Slaves[n].Addr;
+    TxData[0] = Slaves[n].Reg;
+    PTxData = (uint8_t *)TxData;
+    TxCount = 1;
+    PRxData = (uint8_t *)RxData;
+    RxCount = Slaves[n].Len;
+    ReadAfter = 1;
+    Nack = 0;
+    UCB0CTLW0 |= UCTR + UCTXSTT; // Set to transmit and start
+    LPM0;    // Remain in LPM0 until the transaction is over
+    while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+}
+
+//New interval for slave n after a poll
+void Adapt(uint8_t n)
+{
+    Sched_t *s = &Sched[n];
+    s->Polls++;
+    if (Nack) //Missing slave: back off as if unchanged, so it does not cost a poll every Min
+    {
+        s->Nacks++;
+        s->Quiet = 0;
+        if (s->Interval > Slaves[n].Max / 2) s->Interval = Slaves[n].Max;
+        else s->Interval *= 2;
+        return;
+    }
+    Changed = 0;
+    for (j=0;j<Slaves[n].Len;j++)
+        if (RxData[j] != Last[n][j]) { Last[n][j] = RxData[j]; Changed = 1; }
+    if (Changed)
+    {
+        s->Changes++;
+        s->Interval = Slaves[n].Min; //Back to fast polling
+        s->Quiet = 0;
+        P1OUT ^= BIT0; //Green
+    }
+    else if (++s->Quiet >= QUIET)
+    {
+        s->Quiet = 0;
+        if (s->Interval > Slaves[n].Max / 2) s->Interval = Slaves[n].Max;
+        else s->Interval *= 2;
+    }
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+    //Set ACLK
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    CSCTL2 |= SELA__VLOCLK;  //Set ACLK to VLO
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+    //Timer A0 counts the VLO continuously; CCR0 marks the next due slave
+    TA0CCTL0 = CCIE;
+    TA0CTL = TASSEL__ACLK + MC__CONTINUOUS + TACLR;
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0CTLW0 &= ~UCSWRST;
+    UCB0IE |= UCTXIE0 + UCRXIE0 + UCNACKIE;
+    __enable_interrupt(); //Enable global interrupts.
+
+    Then = TimerNow();
+    for (i=0;i<NSLAVES;i++)
+    {
+        Sched[i].Interval = Slaves[i].Min;
+        Sched[i].Due = Then + 100 * (i + 1); //Spread the first polls
+    }
+
+    while(1)
+    {
+        //Sleep until the earliest due slave
+        Next = Sched[0].Due;
+        for (i=1;i<NSLAVES;i++) if ((int16_t)(Sched[i].Due - Next) < 0) Next = Sched[i].Due;
+        TA0CCR0 = Next;
+        __disable_interrupt();
+        if ((int16_t)(Next - TimerNow()) > 1) __bis_SR_register(LPM3_bits + GIE); //CCR0 interrupt wakes main
+        __enable_interrupt();
+
+        Now = TimerNow();
+        Elapsed += (uint16_t)(Now - Then);
+        Then = Now;
+        for (i=0;i<NSLAVES;i++)
+        {
+            if ((int16_t)(Sched[i].Due - Now) > 0) continue;
+            Poll(i);
+            Adapt(i);
+            Total++;
+            Sched[i].Due = Now + Sched[i].Interval;
+        }
+        Fixed = Elapsed / PERIOD * NSLAVES;
+        for (i=0;i<NSLAVES;i++) if (Sched[i].Nacks) P4OUT |= BIT6; //Red
+    }
+}
+
+#pragma vector=TIMER0_A0_VECTOR
+ __interrupt void timerfoo (void)
+{
+    LPM3_EXIT;
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP;
+                        UCB0IFG &= ~UCTXIFG0;
+                        Nack = 1;
+                        LPM0_EXIT;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else if (ReadAfter)
+                            {
+                                ReadAfter = 0;
+                                UCB0CTLW0 &= ~UCTR; //Receiver
+                                UCB0CTLW0 |= UCTXSTT; //Repeated start
+                                UCB0IFG &= ~UCTXIFG0;
+                                if (RxCount == 1) //Single byte: STOP as soon as the address is out
+                                {
+                                    while (UCB0CTLW0 & UCTXSTT);
+                                    UCB0CTLW0 |= UCTXSTP;
+                                }
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
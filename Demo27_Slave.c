@@ -0,0 +1,174 @@
+ /*I2C demo with MSP430FR2355 Launchpad as SLAVE serving ADC measurements that are always ready, so a read never
+  waits on a conversion. Companion of any master that reads 10 bytes at 0x77 (Demo6_Master.c, Demo26_Master.c).
+  Timer_B1 runs on ACLK = REFO; its TB1.1 output starts a conversion of A1 (P1.1) every SAMPLE counts, about
+  1 kHz, without the CPU (ADCSHS_1, repeat single channel). The FR2355 has no DMA, so the ADC ISR only moves
+  ADCMEM0 into the ring Ring and wakes main once Decim new samples are there. Main averages each block of Decim
+  samples while the bus is free, then publishes the result into the idle half of the double buffer Buf and
+  switches Pub; the I2C ISR takes Buf[Pub] at the START of a read and sends it as is:
+    [0]     Sequence number, +1 per published block
+    [1..2]  Latest sample, low byte first (12 bits)
+    [3..4]  Average of the block
+    [5..6]  Minimum of the block
+    [7..8]  Maximum of the block
+    [9]     Samples dropped because main fell RING samples behind, saturates at 255
+  A read in progress keeps its buffer; a block finished during it is published into the other half, and one
+  finished while the other half is still being read is skipped. A byte written by the master sets Decim (1 to
+  RING / 2, 1 = every sample). The slave sleeps in LPM3 between samples. Green LED toggles per published block.
+    P1.1  A1 analog input
+    P1.2  UCB0SDA with 10k pullup
+    P1.3  UCB0SCL with 10k pullup
+ */
+ #include <msp430.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #define NBYTES 10
+ #define SAMPLE 32 //REFO counts per sample: 32768 / 32 = 1024 Hz
+ #define RING 64 //Power of 2
+ #define NONE 2
+ volatile uint16_t Ring[RING];
+ volatile uint8_t Head, Pending, Overruns;
+ uint8_t Tail;
+ volatile uint8_t Decim = 16;
+ volatile uint8_t Buf[2][NBYTES];
+ volatile uint8_t Pub;          // Half of Buf the next read gets
+ volatile uint8_t Busy = NONE;  // Half being read, NONE when no read is in progress
+ volatile uint8_t *PTxData, TxCount;
+ uint8_t Seq;
+
+ //Average Decim samples from the ring and publish them
+ void Block(uint8_t n)
+ {
+     uint32_t sum = 0;
+     uint16_t v, min = 0xFFFF, max = 0;
+     uint8_t k;
+     volatile uint8_t *b;
+     for (k = 0; k < n; k++)
+     {
+         v = Ring[Tail];
+         Tail = (Tail + 1) & (RING - 1);
+         sum += v;
+         if (v < min) min = v;
+         if (v > max) max = v;
+     }
+     if (Busy == (Pub ^ 1)) return; //Idle half still being read; the next block will get through
+     b = Buf[Pub ^ 1];
+     b[0] = ++Seq;
+     b[1] = v; b[2] = v >> 8;
+     v = sum / n;
+     b[3] = v; b[4] = v >> 8;
+     b[5] = min; b[6] = min >> 8;
+     b[7] = max; b[8] = max >> 8;
+     b[9] = Overruns;
+     Pub ^= 1; //One byte write: a read starting now gets the new block
+     P6OUT ^= BIT6; //Green
+ }
+
+ int main(void)
+ {
+     uint8_t n;
+     WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+     PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+     P1DIR |= BIT0; //Red LED on Launchpad
+     P6DIR |= BIT6; //Green LED on Launchpad
+     P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+     P1SEL0 |= BIT1; //P1.1 analog input A1
+     P1SEL1 |= BIT1;
+     P1OUT &= ~BIT0; //Turn off LEDs
+     P6OUT &= ~BIT6;
+
+     CSCTL4 = SELMS__DCOCLKDIV + SELA__REFOCLK; //ACLK = REFO, runs in LPM3
+
+     //ADC: 12 bits on MODCLK, conversion started by each rising edge of TB1.1
+     ADCCTL0 = ADCSHT_2 + ADCON; //16 clock sample time
+     ADCCTL1 = ADCSHS_1 + ADCSHP + ADCCONSEQ_2 + ADCSSEL_0; //TB1.1 trigger, sampling timer, repeat single channel
+     ADCCTL2 = ADCRES_2; //12 bits
+     ADCMCTL0 = ADCINCH_1 + ADCSREF_0; //A1, AVCC reference
+     ADCIE = ADCIE0;
+     ADCCTL0 |= ADCENC;
+
+     //Timer B1 up mode on ACLK; TB1.1 reset/set gives one rising edge per period
+     TB1CCR0 = SAMPLE - 1;
+     TB1CCR1 = SAMPLE / 2;
+     TB1CCTL1 = OUTMOD_7;
+     TB1CTL = TBSSEL__ACLK + MC__UP + TBCLR;
+
+     //Setup I2C
+     UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+     UCB0I2COA0 = 0x77 | UCOAEN;               // Slave address is 0x77; enable it
+     UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+
+     UCB0IE |= UCRXIE0 + UCTXIE0 + UCSTTIE + UCSTPIE; // Enable receive, transmit, start and stop interrupts
+     __enable_interrupt(); //Enable global interrupts.
+
+     while(1)
+     {
+         __disable_interrupt();
+         n = Decim;
+         if (Pending < n) __bis_SR_register(LPM3_bits + GIE); //Woken by the ADC ISR
+         __enable_interrupt();
+         while (Pending >= (n = Decim))
+         {
+             Block(n);
+             __disable_interrupt();
+             Pending -= n;
+             __enable_interrupt();
+         }
+     }
+ }
+
+ #pragma vector = ADC_VECTOR
+ __interrupt void ADC_ISR(void)
+ {
+   switch(__even_in_range(ADCIV, ADCIV_ADCIFG))
+   {
+     case ADCIV_ADCIFG:
+                             if (Pending < RING)
+                             {
+                                 Ring[Head] = ADCMEM0; //Clears ADCIFG0
+                                 Head = (Head + 1) & (RING - 1);
+                                 Pending++;
+                             }
+                             else //Ring full: drop the new sample
+                             {
+                                 ADCMEM0;
+                                 if (Overruns < 255) Overruns++;
+                             }
+                             if (Pending >= Decim) LPM3_EXIT;
+                             break;
+     default: break;
+   }
+ }
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint8_t b;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;           // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                  // Vector 6: STTIFG
+                             if (UCB0CTLW0 & UCTR) //Read: take the newest complete block
+                             {
+                                 Busy = Pub;
+                                 PTxData = Buf[Busy];
+                                 TxCount = 0;
+                             }
+                             else Busy = NONE;
+                             break;
+     case USCI_I2C_UCSTPIFG:                  // Vector 8: STPIFG
+                             Busy = NONE;
+                             break;
+     case USCI_I2C_UCRXIFG0:                  // Vector 22: RXIFG0
+                             b = UCB0RXBUF;
+                             if (b >= 1 && b <= RING / 2) Decim = b;
+                             break;
+     case USCI_I2C_UCTXIFG0:                  // Vector 24: TXIFG0
+                             if (TxCount < NBYTES) { UCB0TXBUF = PTxData[TxCount]; TxCount++; }
+                             else UCB0TXBUF = 0xFF;
+                             break;
+     default: break;
+   }
+ }
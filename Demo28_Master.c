@@ -0,0 +1,279 @@
+/*I2C demo program for a read cache on the master, so that repeated reads of slave data within a freshness window
+  cost no bus transaction. Master is an MSP430FR5969 Launchpad, slave is Demo23_Slave.c (register map at 0x77) on an
+  MSP430FR2355 Launchpad.
+    Read(addr, reg, dst, n, maxage)   Served from the cache if a line of the same slave covers registers
+                                      reg..reg+n-1 and is no older than both maxage and the max age of that
+                                      line; otherwise the registers are read over the bus (write register,
+                                      repeated START, read n) into a free or the oldest line, which keeps maxage
+                                      as its own max age
+    Write(addr, reg, src, n)          Writes over the bus and invalidates every line of that slave that overlaps
+                                      the registers written
+  Both return 1 on a NACK, or without a transfer if n is 0 or more than LINE. The max age stored with an entry
+  caps every read it serves; a caller can ask for fresher data with a smaller maxage, never for older.
+  Ages are in VLO counts (10000 is about 1 s, maxage <= 65535). Timer_A0 counts the VLO continuously and its
+  overflow interrupt extends it to 32 bits, so a line left unused for longer than the 6.5 s wrap of TA0R does not
+  look fresh again; lines older than 2^31 counts (about 2.5 days) are dropped before the 32-bit time can wrap.
+  A line holds up to LINE bytes, so reading a whole block once lets later reads of single registers in it hit.
+  Stats counts hits, misses, the misses caused by an expired line and the invalidated lines; HitRate is in percent.
+  The loop mimics Demo6_Master.c: every LOOP it reads all 10 registers to test the 3rd one, but accepts data up
+  to MAXAGE old. Every TOGGLE loops it writes the 3rd register, alternating 0x03 and 0x00, which invalidates the
+  line so the next read goes to the slave. Green LED: 3rd register is 0x03. Red LED: other value or NACK.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define ADDR 0x77
+# define NLINES 4 //Cache lines
+# define LINE 10 //Bytes per line
+# define LOOP 1000 //Application loop, ~0.1 s
+# define MAXAGE 10000 //Data may be ~1 s old
+# define TOGGLE 50
+typedef struct {
+    uint8_t Addr, Reg, Len; //Len 0: line empty
+    uint16_t MaxAge; //Freshness window of this entry, VLO counts
+    uint32_t Stamp; //Time when the data was read from the slave
+    uint8_t Data[LINE];
+} Line_t;
+typedef struct {
+    uint32_t Hits, Misses, Expired, Invalidated;
+} Stats_t;
+
+volatile Line_t Cache[NLINES]; //The overflow ISR drops lines that get too old
+Stats_t Stats;
+uint8_t HitRate;
+volatile uint8_t RxCount, TxCount, RxData[LINE], TxData[LINE + 1], Nack, ReadAfter;
+volatile uint8_t *PRxData, *PTxData;   // Pointers to RX and TX data
+uint8_t Buf[LINE], Value, i;
+uint16_t Loops;
+volatile uint16_t Overflows; //Upper half of the 32-bit time
+
+//32-bit VLO time. Timer_A0 runs asynchronous to MCLK; read until two reads agree
+uint32_t TimerNow(void)
+{
+    uint16_t t, hi;
+    __disable_interrupt();
+    do t = TA0R; while (t != TA0R);
+    hi = Overflows;
+    if ((TA0CTL & TAIFG) && (t < 0x8000)) hi++; //Wrapped, but the ISR has not run yet
+    __enable_interrupt();
+    return ((uint32_t)hi << 16) | t;
+}
+
+//Write count bytes of TxData; with nrx, follow with a repeated start and read nrx bytes into RxData
+void Transfer(uint8_t addr, uint8_t count, uint8_t nrx)
+{
+    UCB0I2CSA = addr;
+    PTxData = (uint8_t *)TxData;
+    TxCount = count;
+    PRxData = (uint8_t *)RxData;
+    RxCount = nrx;
+    ReadAfter = nrx != 0;
+    Nack = 0;
+    UCB0CTLW0 |= UCTR + UCTXSTT; // Set to transmit and start
+    LPM0;    // Remain in LPM0 until the transaction is over
+    while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+}
+
+//Read n registers from reg on, from the cache if fresh enough. Returns 1 on a NACK
+uint8_t Read(uint8_t addr, uint8_t reg, uint8_t *dst, uint8_t n, uint16_t maxage)
+{
+    volatile Line_t *l, *victim = 0;
+    uint32_t now, age, oldest = 0;
+    uint8_t k;
+    if (!n || (n > LINE)) return 1; //Does not fit a line or the transfer buffers
+    now = TimerNow();
+    for (l = Cache; l < Cache + NLINES; l++)
+    {
+        if (l->Len && (l->Addr == addr) && (reg >= l->Reg) && (reg + n <= l->Reg + l->Len))
+        {
+            if (now - l->Stamp <= (maxage < l->MaxAge ? maxage : l->MaxAge))
+            {
+                for (k=0;k<n;k++) dst[k] = l->Data[reg - l->Reg + k];
+                Stats.Hits++;
+                return 0;
+            }
+            Stats.Expired++;
+            victim = l; //Refresh this line
+            break;
+        }
+    }
+    Stats.Misses++;
+    if (!victim) //Empty line, else the oldest one
+    {
+        for (l = Cache; l < Cache + NLINES; l++)
+        {
+            age = now - l->Stamp;
+            if (!l->Len) { victim = l; break; }
+            if (!victim || age > oldest) { victim = l; oldest = age; }
+        }
+    }
+    TxData[0] = reg;
+    Transfer(addr, 1, n);
+    if (Nack) { victim->Len = 0; return 1; }
+    victim->Addr = addr;
+    victim->Reg = reg;
+    victim->MaxAge = maxage;
+    victim->Stamp = now; //Age counts from before the transfer
+    victim->Len = n;
+    for (k=0;k<n;k++) dst[k] = victim->Data[k] = RxData[k];
+    return 0;
+}
+
+//Write n registers from reg on and drop the cached copies they overlap. Returns 1 on a NACK
+uint8_t Write(uint8_t addr, uint8_t reg, const uint8_t *src, uint8_t n)
+{
+    volatile Line_t *l;
+    uint8_t k;
+    if (!n || (n > LINE)) return 1;
+    TxData[0] = reg;
+    for (k=0;k<n;k++) TxData[k+1] = src[k];
+    Transfer(addr, n + 1, 0);
+    for (l = Cache; l < Cache + NLINES; l++)
+    {
+        if (l->Len && (l->Addr == addr) && (reg < l->Reg + l->Len) && (reg + n > l->Reg))
+        {
+            l->Len = 0;
+            Stats.Invalidated++;
+        }
+    }
+    return Nack;
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+    //Set ACLK
+    CSCTL0 = CSKEY; //Password to unlock the clock registers
+    CSCTL2 |= SELA__VLOCLK;  //Set ACLK to VLO
+    CSCTL0_H = 0xFF; //Re-lock the clock registers
+    //Timer A0 counts the VLO continuously: cache ages with the overflow interrupt, and CCR0 paces the loop
+    TA0CCR0 = LOOP;
+    TA0CCTL0 = CCIE;
+    TA0CTL = TASSEL__ACLK + MC__CONTINUOUS + TACLR + TAIE;
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0CTLW0 &= ~UCSWRST;
+    UCB0IE |= UCTXIE0 + UCRXIE0 + UCNACKIE;
+    __enable_interrupt(); //Enable global interrupts.
+
+    Value = 0x03;
+    while(1)
+    {
+        LPM3;       //Wait for the next loop
+        TA0CCR0 += LOOP;
+        if (++Loops == TOGGLE)
+        {
+            Loops = 0;
+            Value ^= 0x03;
+            Write(ADDR, 2, &Value, 1);
+        }
+        //The application reads the whole block every time, as Demo 6 does
+        P1OUT &= ~BIT0;
+        P4OUT &= ~BIT6;
+        if (!Read(ADDR, 0, Buf, 10, MAXAGE) && (Buf[2] == 0x03)) P1OUT |= BIT0; //Green
+        else P4OUT |= BIT6; //Red
+        if (Stats.Hits + Stats.Misses) HitRate = (uint64_t)Stats.Hits * 100 / (Stats.Hits + Stats.Misses);
+    }
+}
+
+#pragma vector=TIMER0_A0_VECTOR
+ __interrupt void timerfoo (void)
+{
+    LPM3_EXIT;
+}
+
+//TA0R wrapped: extend the time and drop lines before their age can wrap too
+#pragma vector=TIMER0_A1_VECTOR
+ __interrupt void Timer_A0_Overflow (void)
+{
+    volatile Line_t *l;
+    switch(__even_in_range(TA0IV, TA0IV_TAIFG))
+    {
+        case TA0IV_TAIFG:
+            Overflows++;
+            for (l = Cache; l < Cache + NLINES; l++)
+                if ((uint16_t)(Overflows - (uint16_t)(l->Stamp >> 16)) >= 0x8000) l->Len = 0;
+            break;
+        default: break;
+    }
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP;
+                        UCB0IFG &= ~UCTXIFG0;
+                        Nack = 1;
+                        LPM0_EXIT;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;         // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22:                // Vector 22: RXIFG0
+                        RxCount--;        // Decrement RX byte counter
+                        if (RxCount) //Execute the following if counter not zero
+                            {
+                                *PRxData++ = UCB0RXBUF; // Move RX data to address PRxData
+                                if (RxCount == 1)     // Only one byte left?
+                                UCB0CTLW0 |= UCTXSTP;    // Generate I2C stop condition BEFORE last read
+                            }
+                        else
+                            {
+                                *PRxData = UCB0RXBUF;   // Move final RX data to PRxData(0)
+                                LPM0_EXIT;             // Exit active CPU
+                            }
+                        break;
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else if (ReadAfter)
+                            {
+                                ReadAfter = 0;
+                                UCB0CTLW0 &= ~UCTR; //Receiver
+                                UCB0CTLW0 |= UCTXSTT; //Repeated start
+                                UCB0IFG &= ~UCTXIFG0;
+                                if (RxCount == 1) //Single byte: STOP as soon as the address is out
+                                {
+                                    while (UCB0CTLW0 & UCTXSTT);
+                                    UCB0CTLW0 |= UCTXSTP;
+                                }
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
@@ -0,0 +1,226 @@
+/*I2C demo program for transfer priorities on a single bus: a long bulk transfer is split into segments so that an
+  urgent command waits for at most one segment. Master is an MSP430FR5969 Launchpad, slave is Demo23_Slave.c
+  (register map at 0x77) on an MSP430FR2355 Launchpad.
+    Bulk     BULK registers from 0 on, rewritten over and over; each transaction carries the register number and
+             at most Seg data bytes, so a block takes BULK / Seg transactions
+    Urgent   the alternating control strings of Demo7_Master.c, {1,2,3} and {4,5,6}, written to REG_CMD
+  Transactions are chained from the STOP interrupt: when one ends, the ISR starts a queued urgent command if there is
+  one, else the next bulk segment. An urgent command arriving while the bus is busy therefore waits until the end
+  of the current transaction, which is at most one segment long.
+  Timer_A1 on SMCLK issues NURGENT urgent commands at irregular intervals of 3 to 5 ms while the bulk transfer keeps
+  the bus busy. Timer_B0 on SMCLK (1 MHz) stamps each request; its latency runs from the request to the STOP of
+  its transaction. The benchmark runs once with Seg = BULK (no splitting) and once with Seg = SEG; Bench[] holds the
+  average and worst latency in us and the bulk data rate in bytes per second for each. Queue overflows are counted
+  in Dropped. Green LED: benchmark done. Red LED: a transfer was NACKed.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define ADDR 0x77
+# define BULK 24 //Bulk block, registers 0..BULK-1
+# define SEG 4 //Data bytes per bulk segment
+# define REG_CMD 0x1C //Urgent command registers, outside the bulk block
+# define NURGENT 200
+# define UQ 4 //Urgent queue, power of 2
+typedef struct {
+    uint16_t Avg, Max; //Urgent latency in us, request to STOP
+    uint16_t BulkRate; //Bulk bytes per second
+} Bench_t;
+
+Bench_t Bench[2];
+const uint8_t Msg1[]={1,2,3}, Msg2[]={4,5,6};
+uint8_t BulkData[BULK];
+volatile uint16_t UrgQ[UQ]; //Request times of the queued urgent commands
+volatile uint8_t UHead, UTail, UCount;
+volatile uint8_t Seg, BulkOn, BulkPos, Idle = 1, Urgent, Nack, First;
+volatile uint8_t Reg, TxCount, Cmd;
+const volatile uint8_t *PTxData;
+volatile uint16_t Issued, Done, Dropped, Nacks, Lfsr = 0xACE1, LatMax;
+volatile uint32_t LatSum, Span, BulkBytes;
+uint8_t i, m;
+
+//Start the next transaction: urgent first, else the next bulk segment. Interrupts disabled or in an ISR
+void Next(void)
+{
+    if (UCount)
+    {
+        Urgent = 1;
+        Reg = REG_CMD;
+        Cmd ^= 1;
+        PTxData = Cmd ? Msg1 : Msg2;
+        TxCount = 3;
+    }
+    else if (BulkOn)
+    {
+        Urgent = 0;
+        Reg = BulkPos;
+        PTxData = &BulkData[BulkPos];
+        TxCount = (BULK - BulkPos < Seg) ? BULK - BulkPos : Seg;
+    }
+    else
+    {
+        Idle = 1;
+        return;
+    }
+    Idle = 0;
+    First = 1;
+    UCB0CTLW0 |= UCTR + UCTXSTT; // Set to transmit and start
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT &= ~BIT0; //green LED off
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0I2CSA = ADDR;
+    UCB0CTLW0 &= ~UCSWRST;
+    UCB0IE |= UCTXIE0 + UCNACKIE + UCSTPIE;
+    //Timer B0 stamps requests, Timer A1 issues them; both free run on SMCLK
+    TB0CTL = TBSSEL__SMCLK + MC__CONTINUOUS + TBCLR;
+    TA1CTL = TASSEL__SMCLK + MC__CONTINUOUS + TACLR;
+    for (i=0;i<BULK;i++) BulkData[i] = i;
+    __enable_interrupt(); //Enable global interrupts.
+
+    for (m=0;m<2;m++)
+    {
+        Seg = m ? SEG : BULK;
+        Issued = 0;
+        Done = 0;
+        Dropped = 0;
+        LatSum = 0;
+        LatMax = 0;
+        Span = 0;
+        BulkBytes = 0;
+        BulkPos = 0;
+        BulkOn = 1;
+        __disable_interrupt();
+        TA1CCR0 = TA1R + 3000;
+        TA1CCTL0 = CCIE;
+        Next(); //Bulk traffic from now on
+        while (Done < NURGENT)
+        {
+            __bis_SR_register(LPM0_bits + GIE); //Woken after the last urgent command
+            __disable_interrupt();
+        }
+        TA1CCTL0 = 0;
+        BulkOn = 0;
+        while (!Idle) //Let the current segment finish
+        {
+            __bis_SR_register(LPM0_bits + GIE);
+            __disable_interrupt();
+        }
+        __enable_interrupt();
+        if (Dropped < NURGENT) Bench[m].Avg = LatSum / (NURGENT - Dropped);
+        Bench[m].Max = LatMax;
+        Bench[m].BulkRate = BulkBytes * 1000 / (Span / 1000);
+    }
+
+    if (Nacks) P4OUT |= BIT6; //Red
+    else P1OUT |= BIT0; //Green
+    while(1) LPM4; //Results are in Bench[]
+}
+
+//Urgent command generator: 3 to 5 ms apart, pseudo-random so it does not lock to the bulk segments
+#pragma vector = TIMER1_A0_VECTOR
+__interrupt void TIMER1_A0(void)
+{
+    uint16_t gap;
+    Lfsr = (Lfsr >> 1) ^ (-(Lfsr & 1) & 0xB400);
+    gap = 3000 + (Lfsr & 0x7FF);
+    TA1CCR0 += gap;
+    Span += gap;
+    if (Issued >= NURGENT) return;
+    Issued++;
+    if (UCount == UQ) //Queue full; counts as done so the run ends
+    {
+        Dropped++;
+        if (++Done >= NURGENT) LPM0_EXIT;
+        return;
+    }
+    UrgQ[UHead] = TB0R;
+    UHead = (UHead + 1) & (UQ - 1);
+    UCount++;
+    if (Idle) Next();
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    uint16_t lat;
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP;
+                        UCB0IFG &= ~UCTXIFG0;
+                        Nack = 1;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8:                // Vector 8: STPIFG, end of a transaction
+                        if (Nack)
+                        {
+                            Nack = 0;
+                            Nacks++;
+                        }
+                        if (Urgent)
+                        {
+                            lat = TB0R - UrgQ[UTail];
+                            UTail = (UTail + 1) & (UQ - 1);
+                            UCount--;
+                            LatSum += lat;
+                            if (lat > LatMax) LatMax = lat;
+                            if (++Done >= NURGENT) LPM0_EXIT;
+                        }
+                        else
+                        {
+                            BulkBytes += PTxData - &BulkData[BulkPos];
+                            BulkPos = PTxData - BulkData;
+                            if (BulkPos >= BULK) BulkPos = 0;
+                        }
+                        Next();
+                        if (Idle) LPM0_EXIT; //Bus released at the end of a run
+                        break;
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22: break;         // Vector 22: RXIFG0
+        case 24:                // Vector 24: TXIFG0
+                        if (First)      // Register number first
+                            {
+                                UCB0TXBUF = Reg;
+                                First = 0;
+                            }
+                        else if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else
+                            {
+                                UCB0CTLW0 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
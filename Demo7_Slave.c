@@ -1,15 +1,42 @@
 /* MSP430FR2355 Launchpad as slave on I2C bus. Runs in a timed loop to blink green LED.
-   Receipt of 3-byte sequence 0x00 0x01 0x02 from master halts the loop, latches
+   Receipt of 3-byte sequence 0x01 0x02 0x03 from master halts the loop, latches
    the red LED, and enters LPM4. The 3-byte sequence 0x04 0x05 0x06 restarts the
    loop and clears the red LED.
+   Messages are passed from the I2C ISR to main through a lock-free single-producer/single-consumer
+   queue. The ISR fills the slot at QHead between start and stop, and publishes it on the stop
+   condition by advancing QHead. Main only reads slots between QTail and QHead and then advances QTail.
+   Each index has a single writer and byte writes are atomic, so no interrupts need to be disabled.
+   Bursts of up to QSIZE-1 messages are held until main catches up; further messages are counted in QOverflow.
      P1.2 SDA on UCB0
      P1.3 SCL on UCB0
 */
 #include <msp430.h>
 #include <stdint.h>
 
-volatile uint8_t RxData[3], RxCount;
-volatile uint8_t *PRxData;   // Pointer to receive buffer
+#define MSGLEN 3 //Longest message kept; longer writes are truncated and marked by Len > MSGLEN
+#define QSIZE 4  //Number of slots, power of 2. One slot is always free for the ISR to fill
+
+typedef struct {
+    uint8_t Len; //Bytes received in the transaction, including any beyond MSGLEN
+    uint8_t Data[MSGLEN];
+} Msg_t;
+
+volatile Msg_t Queue[QSIZE];
+volatile uint8_t QHead, QTail; //QHead written only by the ISR, QTail only by main
+volatile uint16_t QOverflow; //Messages lost because the queue was full
+volatile uint8_t Running; //Written only by main
+Msg_t Msg;
+
+//Copy the oldest message out of the queue. Returns 0 if empty
+uint8_t Pop(Msg_t *m)
+{
+    uint8_t i;
+    if (QTail == QHead) return 0;
+    m->Len = Queue[QTail].Len;
+    for (i=0;i<MSGLEN;i++) m->Data[i] = Queue[QTail].Data[i];
+    QTail = (QTail + 1) & (QSIZE - 1); //Hand the slot back to the ISR
+    return 1;
+}
 
 void main(void) {
 
@@ -32,66 +59,54 @@ void main(void) {
     UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
     UCB0I2COA0 = 0x77 | UCOAEN;               // Slave address is 0x77; enable it
     UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
-    UCB0IE |= UCRXIE0;              // Enable receive I2C interrupt
-    __enable_interrupt(); //Enable global interrupts.
+    UCB0IE |= UCRXIE0 + UCSTTIE + UCSTPIE;    // Enable receive, start and stop I2C interrupts
 
-     RxCount =0;
+    QHead = 0;
+    QTail = 0;
+    QOverflow = 0;
+    Running = 1;
+    __enable_interrupt(); //Enable global interrupts.
 
     //Main loop follows
     while(1)
     {
-        TB0CCR0 = 1100; //Looping period
-        TB0CTL |= TBCLR; //Clear the timer counter
-        LPM0;      //Wait in low power mode for timeout
-        P6OUT |= BIT6; //Flash green LED
-        TB0CCR0 = 100;
-        TB0CTL |= TBCLR;
-        LPM0;
-        P6OUT &= ~BIT6; //LED off
-       if (RxCount == 0) ;
-       else if (RxCount == 3)
+        if (Running)
+        {
+            TB0CCR0 = 1100; //Looping period
+            TB0CTL |= TBCLR; //Clear the timer counter
+            LPM0;      //Wait in low power mode for timeout
+            P6OUT |= BIT6; //Flash green LED
+            TB0CCR0 = 100;
+            TB0CTL |= TBCLR;
+            LPM0;
+            P6OUT &= ~BIT6; //LED off
+        }
+        //Handle every message that arrived, in order
+        while (Pop(&Msg))
         {
-            PRxData = (uint8_t *)RxData;    // Point PRxData to start of RxData
-            if ((*PRxData == 1) && (*PRxData+1 == 2) && (*PRxData+2 == 3))
+            if (Msg.Len != 3) continue; //Only 3-byte commands are valid
+            if ((Msg.Data[0] == 1) && (Msg.Data[1] == 2) && (Msg.Data[2] == 3))
             {
                 //Stop loop
-                RxCount=0;
-                P1OUT|= BIT0; //Red LED on
-                TB0CTL = MC_0; //Stop the timer
-                LPM4; //Wait for RXIFG in LPM4
-                //Rx interrupt flag is raised. Need some time to read the I2C bus
-                __delay_cycles(100);
-                //Check for correct 3 byte string
-                while(1)
-                {
-                        if (RxCount == 3)
-                        {
-                            PRxData = (uint8_t *)RxData; // Point PRxData to start of RxData
-                            if ((*PRxData == 4) && (*PRxData+1 == 5) && (*PRxData+2 == 6)) //Re-start slave loop
-                            {
-                                RxCount=0;
-                                P1OUT &= ~BIT0; //Clear red LED
-                                TB0CTL |= MC_1 + TBSSEL__ACLK + TBCLR; //Restart timer
-                                break;
-                            }
-                            else //Incorrect 3-byte command; go back to sleep
-                            {
-                                RxCount=0;
-                                LPM4; //Wait in LPM4 for master data
-                                __delay_cycles(100);
-                            }
-                        }
-                        else //Need to receive 3 bytes to re-start loop
-                        {
-                            RxCount=0;
-                            LPM4; //Wait in LPM4 for master data
-                            __delay_cycles(100);
-                    }
-                }
+                Running = 0;
+                P1OUT |= BIT0; //Red LED on
+                TB0CTL &= ~MC_3; //Stop the timer
+            }
+            else if ((Msg.Data[0] == 4) && (Msg.Data[1] == 5) && (Msg.Data[2] == 6))
+            {
+                //Re-start slave loop
+                Running = 1;
+                P1OUT &= ~BIT0; //Clear red LED
+                TB0CTL |= MC_1 + TBCLR; //Restart timer
             }
-            else RxCount=0;
         }
-        else RxCount=0; //Byte count != 0 or !=3; reset count
+        if (!Running)
+        {
+            //Check the queue with interrupts off so a message cannot slip in before LPM4
+            __disable_interrupt();
+            if (QTail == QHead) __bis_SR_register(LPM4_bits + GIE); //Wait in LPM4 for master data
+            else __enable_interrupt();
+        }
     } //end of main loop
 }
 
@@ -104,13 +119,26 @@ void main(void) {
  #pragma vector = USCI_B0_VECTOR
  __interrupt void USCIB0_ISR(void)
  {
+   uint8_t next;
    switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
    {
      case USCI_NONE:         break;           // Vector 0: No interrupts
      case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
      case USCI_I2C_UCNACKIFG:break;         // Vector 4: NACKIFG
-     case USCI_I2C_UCSTTIFG: break;          // Vector 6: STTIFG
-     case USCI_I2C_UCSTPIFG: break;            // Vector 8: STPIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             Queue[QHead].Len = 0; //Start filling the free slot
+                             break;
+     case USCI_I2C_UCSTPIFG:                 // Vector 8: STPIFG
+                             UCB0IFG &= ~UCSTPIFG;
+                             if (Queue[QHead].Len == 0) break; //Nothing was written
+                             next = (QHead + 1) & (QSIZE - 1);
+                             if (next == QTail) QOverflow++; //Queue full; slot is reused for the next message
+                             else
+                             {
+                                 QHead = next; //Publish the message to main
+                                 if (!Running) LPM4_EXIT; //A running loop checks the queue once per cycle
+                             }
+                             break;
      case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
      case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
      case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
@@ -119,10 +147,11 @@ void main(void) {
      case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
      case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
      /* I2C data will load into the buffer when in low power modes.
-      Exiting from LPM must take place inside the interrupt. */
-                             if (RxCount==0) LPM4_EXIT;
-                             RxCount++;
-                             *PRxData++ = UCB0RXBUF;
+      Bytes beyond MSGLEN are read and counted but not stored. */
+                             next = Queue[QHead].Len;
+                             if (next < MSGLEN) Queue[QHead].Data[next] = UCB0RXBUF;
+                             else UCB0RXBUF;
+                             if (next < 0xFF) Queue[QHead].Len = next + 1;
                              break;
      case USCI_I2C_UCTXIFG0: break;            // Vector 26: TXIFG0
      case USCI_I2C_UCBCNTIFG: break;         // Vector 28: BCNTIFG
@@ -131,4 +160,3 @@ void main(void) {
      default: break;
    }
  }
-
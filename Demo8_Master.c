@@ -0,0 +1,127 @@
+/*  General call broadcast of the Demo 7 stop/start commands. Data sent with button press on P1.1.
+    Instead of addressing a single slave at 0x77, the master writes to the general call address 0x00
+    so every slave on the bus receives the command in the same transaction. The first byte of the
+    payload is a group mask; slaves act on the command only if they belong to one of the groups in the mask.
+    Payload: GroupMask, then the 3-byte code 123 (stop loop) or 456 (start loop).
+    Green and red LEDs flash with alternating commands. This is the MASTER code on MSP430FR5969 Launchpad.
+    P1.6  UCB0SDA with 10k pullup
+    P1.7  UCB0SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#define GENERAL_CALL 0x00 //Reserved I2C address received by all slaves with UCGCEN set
+#define GROUP_ALL 0xFF //Mask selecting every group. Use e.g. BIT0 + BIT2 to address a subset of slaves
+volatile uint8_t TxCount, Control_Byte, i, Nack;
+volatile uint8_t *PTxData;   // Pointer to TX data
+volatile uint8_t TxData[4], Msg1[]={1,2,3}, Msg2[]={4,5,6};
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlocks GPIO pins at power-up
+    P1DIR |= BIT0 + BIT2 + BIT3 + BIT4 + BIT5;
+    P1SEL1 |= BIT6 + BIT7; //Setup I2C on UCB0
+    P1OUT = BIT1; // Pull-up resistor on P1.1
+    P1REN = BIT1; // Select pull-up mode for P1.1
+    P1IES = BIT1; // P1.1 Hi/Lo edge
+    P1IFG = 0;    // Clear all P1 interrupt flags
+    P1IE = BIT1;  // P1.1 interrupt enabled
+    P1OUT &= ~BIT0; //green LED off
+
+    P4DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7;
+    P4OUT &= ~BIT6; //red LED off
+
+    // Configure the eUSCI_B0 module for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCTR + UCSYNC + UCMODE_3; //Select SMCLK, master, transmitter, synchronous, I2C
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0I2CSA = GENERAL_CALL; // Broadcast to all slaves
+    UCB0CTLW0 &= ~UCSWRST; // Clear reset
+
+    UCB0IE |= UCTXIE0 + UCNACKIE; //Enable I2C transmission and NACK interrupts
+    __enable_interrupt(); //Enable global interrupts.
+    Control_Byte=0x01;
+
+    while(1)
+    {
+        LPM4;       //Wait for pushbutton interrupt in low power mode
+        Control_Byte ^= BIT0; //Toggle control byte
+        TxData[0] = GROUP_ALL; //Group mask goes first
+        if(Control_Byte == 0x01)
+        {
+            for(i=0;i<3;i++)TxData[i+1]=Msg1[i];
+            P4OUT |= BIT6; //Red LED on
+        }
+        else
+        {
+            for(i=0;i<3;i++)TxData[i+1]=Msg2[i];
+            P1OUT |= BIT0; //Green LED on
+        }
+        PTxData = (uint8_t *)TxData; //Set pointer to start of TX array
+        TxCount = 4; //Send mask and command to all slaves
+        Nack = 0;
+        UCB0CTLW0 |= UCTXSTT; // Set to transmit and start
+        LPM0;    // Remain in LPM0 until all data transmitted or no slave answered
+        while (UCB0CTLW0 & UCTXSTP);  // Ensure stop condition got sent
+        if (Nack) //No slave acknowledged the general call; flash both LEDs
+        {
+            P1OUT |= BIT0;
+            P4OUT |= BIT6;
+        }
+        __delay_cycles(10000);
+        P1OUT &= ~BIT0; //LEDs off
+        P4OUT &= ~BIT6;
+    }
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+{
+    switch(__even_in_range(UCB0IV,30))
+    {
+        case 0: break;         // Vector 0: No interrupts
+        case 2: break;         // Vector 2: ALIFG
+        case 4:                // Vector 4: NACKIFG
+                        UCB0CTLW0 |= UCTXSTP; // Release the bus
+                        UCB0IFG &= ~UCTXIFG0;
+                        Nack = 1;
+                        LPM0_EXIT;
+                        break;
+        case 6: break;         // Vector 6: STTIFG
+        case 8: break;        // Vector 8: STPIFG
+        case 10: break;         // Vector 10: RXIFG3
+        case 12: break;         // Vector 12: TXIFG3
+        case 14: break;         // Vector 14: RXIFG2
+        case 16: break;         // Vector 16: TXIFG2
+        case 18: break;         // Vector 18: RXIFG1
+        case 20: break;         // Vector 20: TXIFG1
+        case 22: break;         // Vector 22: RXIFG0
+        case 24:                // Vector 24: TXIFG0
+                        if (TxCount)      // Check if TX byte counter not empty
+                            {
+                                UCB0TXBUF = *PTxData++; // Load TX buffer
+                                TxCount--;            // Decrement TX byte counter
+                            }
+                        else
+                            {
+                                UCB0CTL1 |= UCTXSTP; // I2C stop condition
+                                UCB0IFG &= ~UCTXIFG0;  // Clear USCI_B0 TX int flag
+                                LPM0_EXIT;      // Exit LPM0
+                            }
+                        break;
+        case 26: break;        // Vector 26: BCNTIFG
+        case 28: break;         // Vector 28: clock low timeout
+        case 30: break;         // Vector 30: 9th bit
+        default: break;
+    }
+}
+
+#pragma vector=PORT1_VECTOR
+__interrupt void Port_1(void)
+{
+  P1IFG &= ~BIT1;  // Clear P1.1 IFG
+  LPM4_EXIT;     // Exit LPM4
+}
@@ -0,0 +1,143 @@
+/* MSP430FR2355 as slave on I2C bus with general call enabled. Runs in a timed loop to blink green LED.
+   Responds both to its own address 0x77 and to the general call address 0x00, so one broadcast
+   from the master reaches every slave at once. Message is 4 bytes: group mask followed by a 3-byte code.
+   If the mask contains this slave's GROUP, the code 0x01 0x02 0x03 halts the loop, latches the red LED
+   and enters LPM4; the code 0x04 0x05 0x06 restarts the loop and clears the red LED.
+   Messages are checked on the stop condition. Master code is Demo8_Master.c.
+     P1.2 SDA on UCB0
+     P1.3 SCL on UCB0
+*/
+#include <msp430.h>
+#include <stdint.h>
+
+#define GROUP BIT0 //Group membership of this slave. Give each slave its own bit(s) to address subsets
+volatile uint8_t RxData[4], RxCount, NewMsg, Running;
+volatile uint8_t Msg[4];     // Last complete message, copied from RxData on the stop condition
+volatile uint8_t *PRxData;   // Pointer to receive buffer
+uint8_t Cmd[4], New, k;      // Main's copy of Msg, taken with interrupts disabled
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+    PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+    P1SEL0 |= BIT2 + BIT3; //Set I2C pins; P1.2 UCB0SDA; P1.3 UCB0SCL
+    P1DIR |= BIT0 + BIT1 + BIT4 + BIT5 + BIT6 + BIT7; //Set these pins to outputs
+    P6DIR |= BIT0 + BIT1 + BIT2 + BIT3 + BIT4 + BIT5 + BIT6 + BIT7; //Set these pins to outputs
+    P1OUT &= ~BIT0; //LEDs off
+    P6OUT &= ~BIT6;
+
+    CSCTL4 = SELA__VLOCLK;  //Set ACLK to VLO at 10 kHz
+    /* MC_1 to count up to TB0CCR0, set to ACLK (VLO) and divide it by 8.
+    (The measured frequency is 1.2 kHz NOT 1.25 kHz.) */
+    TB0CTL |= MC_1 + TBSSEL__ACLK + TBCLR;
+    TB0EX0 |= TBIDEX_7;
+    TB0CCTL0 = CCIE; //Enable the Timer B interrupt
+
+    UCB0CTLW0 = UCSWRST;                      // Software reset enabled
+    UCB0CTLW0 |= UCMODE_3 + UCSYNC;           // I2C mode, sync mode (Do not set clock in slave mode)
+    UCB0I2COA0 = 0x77 | UCOAEN | UCGCEN;      // Slave address is 0x77; enable it and respond to general call
+    UCB0CTLW0 &= ~UCSWRST;                    // Clear reset register
+    UCB0IE |= UCRXIE0 + UCSTPIE + UCSTTIE;    // Enable receive, start and stop I2C interrupts
+    __enable_interrupt(); //Enable global interrupts.
+
+    PRxData = (uint8_t *)RxData;
+    RxCount = 0;
+    NewMsg = 0;
+    Running = 1;
+
+    //Main loop follows
+    while(1)
+    {
+        if (Running)
+        {
+            TB0CCR0 = 1100; //Looping period
+            TB0CTL |= TBCLR; //Clear the timer counter
+            LPM3;      //Wait in low power mode for timeout; VLO keeps running
+            P6OUT |= BIT6; //Flash green LED
+            TB0CCR0 = 100;
+            TB0CTL |= TBCLR;
+            LPM3;
+            P6OUT &= ~BIT6; //LED off
+        }
+        else
+        {
+            //Loop halted. No clocks needed until the next message. Test and sleep with interrupts disabled,
+            //so a message completed in between still wakes the slave
+            __disable_interrupt();
+            if (!NewMsg) __bis_SR_register(LPM4_bits + GIE);
+            else __enable_interrupt();
+        }
+        __disable_interrupt(); //The ISR may store the next message at any time
+        New = NewMsg;
+        NewMsg = 0;
+        for (k=0;k<4;k++) Cmd[k] = Msg[k];
+        __enable_interrupt();
+        if (New)
+        {
+            //Only act if this slave belongs to one of the groups in the mask
+            if (Cmd[0] & GROUP)
+            {
+                if ((Cmd[1] == 1) && (Cmd[2] == 2) && (Cmd[3] == 3))
+                {
+                    Running = 0;
+                    P1OUT |= BIT0; //Red LED on
+                    TB0CTL &= ~MC_3; //Stop the timer
+                }
+                else if ((Cmd[1] == 4) && (Cmd[2] == 5) && (Cmd[3] == 6))
+                {
+                    Running = 1;
+                    P1OUT &= ~BIT0; //Clear red LED
+                    TB0CTL |= MC_1 + TBCLR; //Restart timer
+                }
+            }
+        }
+    } //end of main loop
+}
+
+#pragma vector=TIMER0_B0_VECTOR //This vector name is in header file
+ __interrupt void Timer_B (void)
+{
+    LPM3_EXIT;
+}
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   uint8_t n;
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:break;          // Vector 4: NACKIFG
+     case USCI_I2C_UCSTTIFG:                 // Vector 6: STTIFG
+                             PRxData = (uint8_t *)RxData; //New message, directed or broadcast
+                             RxCount = 0;
+                             break;
+     case USCI_I2C_UCSTPIFG:                 // Vector 8: STPIFG
+                             UCB0IFG &= ~UCSTPIFG;
+                             if (RxCount == 4) //Complete mask + command
+                             {
+                                 for (n=0;n<4;n++) Msg[n] = RxData[n];
+                                 NewMsg = 1;
+                                 if (!Running) LPM4_EXIT; //A running loop picks it up at the end of the cycle
+                             }
+                             break;
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+     /* General call data arrives on the same RXIFG0 as data addressed to 0x77. */
+                             if (RxCount < 4) *PRxData++ = UCB0RXBUF;
+                             else UCB0RXBUF; //Discard extra bytes to protect the buffer
+                             if (RxCount < 0xFF) RxCount++; //Saturate so a long write cannot wrap back to 4
+                             break;
+     case USCI_I2C_UCTXIFG0:  break;         // Vector 26: TXIFG0
+     case USCI_I2C_UCBCNTIFG: break;         // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
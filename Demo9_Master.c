@@ -0,0 +1,204 @@
+/*I2C demo program to poll slaves on two independent I2C buses at the same time. The FR5969 has only one
+  eUSCI_B module, so this MASTER runs on an MSP430FR2355 Launchpad, which has both eUSCI_B0 and eUSCI_B1.
+  Each slave is assigned to a bus in the address table. On every cycle both buses are started together and
+  each ISR walks its own part of the table, reading 10 bytes per slave and starting the next slave on the
+  same bus directly from the stop interrupt. Transfers on the two buses overlap, so a cycle takes about as long
+  as the busier bus alone. Master wakes from LPM0 only when both buses are finished. If every slave returns
+  0x03 in byte 3, flash green LED; otherwise flash red. Slaves are Demo6_Slave.c or any slave that returns
+  10 bytes on a read. The same slave address can be used on both buses. Timed loop from VLO on Timer_B.
+    P1.2  UCB0SDA with 10k pullup (bus 0)
+    P1.3  UCB0SCL with 10k pullup
+    P4.6  UCB1SDA with 10k pullup (bus 1)
+    P4.7  UCB1SCL with 10k pullup
+  */
+#include <msp430.h>
+#include <stdio.h>
+#include <stdint.h>
+
+# define PERIOD 20000 //Samping period. 10000 count is approximately 1 second; maximum is 65535
+# define BLINK 500
+# define NSLAVES 4 //Number of entries in the address table
+# define NBYTES 10 //Bytes read from each slave
+# define NONE NSLAVES //Returned by NextSlave when a bus has no more slaves
+
+//Address table. SlaveBus selects eUSCI_B0 (0) or eUSCI_B1 (1) for each address
+const uint8_t SlaveAddr[NSLAVES] = {0x77, 0x76, 0x77, 0x76};
+const uint8_t SlaveBus[NSLAVES]  = {0, 0, 1, 1};
+volatile uint8_t RxData[NSLAVES][NBYTES], Nack[NSLAVES];
+volatile uint8_t Slave0, Slave1; //Table index of the current transfer on each bus
+volatile uint8_t *PRxData0, *PRxData1; //Receive pointers, one per bus
+volatile uint8_t BusBusy; //BIT0 for bus 0, BIT1 for bus 1
+uint8_t i, Good;
+
+//Index of the next table entry on the given bus, starting the search at from
+uint8_t NextSlave(uint8_t bus, uint8_t from)
+{
+    while ((from < NSLAVES) && (SlaveBus[from] != bus)) from++;
+    return from;
+}
+
+//Start a read from table entry n on bus 0
+void StartBus0(uint8_t n)
+{
+    Slave0 = n;
+    PRxData0 = RxData[n];
+    UCB0I2CSA = SlaveAddr[n];
+    UCB0CTLW0 |= UCTXSTT;
+}
+
+//Start a read from table entry n on bus 1
+void StartBus1(uint8_t n)
+{
+    Slave1 = n;
+    PRxData1 = RxData[n];
+    UCB1I2CSA = SlaveAddr[n];
+    UCB1CTLW0 |= UCTXSTT;
+}
+
+void main(void) {
+
+    WDTCTL = WDTPW | WDTHOLD;   //Stop watchdog timer
+
+    PM5CTL0 &= ~LOCKLPM5; //Unlock GPIO
+    P1DIR |= BIT0; //Red LED on Launchpad
+    P6DIR |= BIT6; //Green LED on Launchpad
+    P1OUT &= ~BIT0; //LEDs off
+    P6OUT &= ~BIT6;
+    P1SEL0 |= BIT2 + BIT3; //Bus 0; P1.2 UCB0SDA; P1.3 UCB0SCL
+    P4SEL0 |= BIT6 + BIT7; //Bus 1; P4.6 UCB1SDA; P4.7 UCB1SCL
+
+    CSCTL4 = SELA__VLOCLK;  //Set ACLK to VLO at 10 kHz
+    //Enable the timer interrupt, MC_1 to count up to TB0CCR0, Timer B set to ACLK (VLO)
+    TB0CCTL0 = CCIE;
+    TB0CTL |= MC_1 + TBSSEL__ACLK;
+
+    // Configure both eUSCI_B modules identically for I2C at 100 kHz
+    UCB0CTLW0 |= UCSWRST;
+    UCB0CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3; //Select SMCLK, master, receiver, synchronous, I2C
+    UCB0CTLW1 |= UCASTP_2; //Automatic stop after NBYTES
+    UCB0TBCNT = NBYTES;
+    UCB0BRW = 10;  //Divide SMCLK by 10 to get ~100 kHz
+    UCB0CTLW0 &= ~UCSWRST; // Clear reset
+
+    UCB1CTLW0 |= UCSWRST;
+    UCB1CTLW0 |=  UCSSEL__SMCLK + UCMST + UCSYNC + UCMODE_3;
+    UCB1CTLW1 |= UCASTP_2;
+    UCB1TBCNT = NBYTES;
+    UCB1BRW = 10;
+    UCB1CTLW0 &= ~UCSWRST;
+
+    UCB0IE |= UCRXIE0 + UCSTPIE + UCNACKIE; //Enable receive, stop and NACK interrupts on both buses
+    UCB1IE |= UCRXIE0 + UCSTPIE + UCNACKIE;
+    __enable_interrupt(); //Enable global interrupts.
+
+    while(1)
+    {
+        TB0CCR0 = PERIOD; //Looping period with VLO
+        LPM3;       //Wait in low power mode
+        //Timeout. Kick off both buses; the ISRs chain through the rest of the table
+        for (i=0;i<NSLAVES;i++) Nack[i] = 0;
+        BusBusy = 0;
+        if (NextSlave(0,0) != NONE) BusBusy |= BIT0;
+        if (NextSlave(1,0) != NONE) BusBusy |= BIT1;
+        __disable_interrupt(); //Both flags must be set before either ISR can finish
+        if (BusBusy & BIT0) StartBus0(NextSlave(0,0));
+        if (BusBusy & BIT1) StartBus1(NextSlave(1,0));
+        while (BusBusy)
+        {
+            __bis_SR_register(LPM0_bits + GIE); //Wait for both buses in LPM0
+            __disable_interrupt();
+        }
+        __enable_interrupt();
+
+        //Test 3rd byte from every slave. Blink one of the LEDs
+        Good = 1;
+        for (i=0;i<NSLAVES;i++) if (Nack[i] || (RxData[i][2] != 0x03)) Good = 0;
+        if (Good) P6OUT |= BIT6; //Green
+        else P1OUT |= BIT0; //Red
+        TB0CCR0 = BLINK;
+        LPM3;
+        P6OUT &= ~BIT6;
+        P1OUT &= ~BIT0;
+    }
+}
+#pragma vector=TIMER0_B0_VECTOR //This vector name is in header file
+ __interrupt void Timer_B (void)
+{
+    LPM3_EXIT;
+}
+
+ #pragma vector = USCI_B0_VECTOR
+ __interrupt void USCIB0_ISR(void)
+ {
+   switch(__even_in_range(UCB0IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:                 // Vector 4: NACKIFG
+                             Nack[Slave0] = 1; //Slave absent; stop and move on
+                             UCB0CTLW0 |= UCTXSTP;
+                             break;
+     case USCI_I2C_UCSTTIFG: break;          // Vector 6: STTIFG
+     case USCI_I2C_UCSTPIFG:                 // Vector 8: STPIFG
+                             Slave0 = NextSlave(0, Slave0 + 1);
+                             if (Slave0 != NONE) StartBus0(Slave0); //Chain to the next slave on this bus
+                             else
+                             {
+                                 BusBusy &= ~BIT0;
+                                 if (!BusBusy) LPM0_EXIT; //Wake main when both buses are finished
+                             }
+                             break;
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             *PRxData0++ = UCB0RXBUF;
+                             break;
+     case USCI_I2C_UCTXIFG0: break;          // Vector 26: TXIFG0
+     case USCI_I2C_UCBCNTIFG: break;         // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
+
+ #pragma vector = USCI_B1_VECTOR
+ __interrupt void USCIB1_ISR(void)
+ {
+   switch(__even_in_range(UCB1IV, USCI_I2C_UCBIT9IFG))
+   {
+     case USCI_NONE:         break;           // Vector 0: No interrupts
+     case USCI_I2C_UCALIFG:  break;           // Vector 2: ALIFG
+     case USCI_I2C_UCNACKIFG:                 // Vector 4: NACKIFG
+                             Nack[Slave1] = 1;
+                             UCB1CTLW0 |= UCTXSTP;
+                             break;
+     case USCI_I2C_UCSTTIFG: break;          // Vector 6: STTIFG
+     case USCI_I2C_UCSTPIFG:                 // Vector 8: STPIFG
+                             Slave1 = NextSlave(1, Slave1 + 1);
+                             if (Slave1 != NONE) StartBus1(Slave1);
+                             else
+                             {
+                                 BusBusy &= ~BIT1;
+                                 if (!BusBusy) LPM0_EXIT;
+                             }
+                             break;
+     case USCI_I2C_UCRXIFG3: break;          // Vector 10: RXIFG3
+     case USCI_I2C_UCTXIFG3: break;          // Vector 14: TXIFG3
+     case USCI_I2C_UCRXIFG2: break;          // Vector 16: RXIFG2
+     case USCI_I2C_UCTXIFG2: break;          // Vector 18: TXIFG2
+     case USCI_I2C_UCRXIFG1: break;          // Vector 20: RXIFG1
+     case USCI_I2C_UCTXIFG1: break;          // Vector 22: TXIFG1
+     case USCI_I2C_UCRXIFG0:                 // Vector 24: RXIFG0
+                             *PRxData1++ = UCB1RXBUF;
+                             break;
+     case USCI_I2C_UCTXIFG0: break;          // Vector 26: TXIFG0
+     case USCI_I2C_UCBCNTIFG: break;         // Vector 28: BCNTIFG
+     case USCI_I2C_UCCLTOIFG: break;         // Vector 30: clock low timeout
+     case USCI_I2C_UCBIT9IFG: break;         // Vector 32: 9th bit
+     default: break;
+   }
+ }
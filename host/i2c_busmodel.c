@@ -0,0 +1,342 @@
+/* Bit-level I2C bus model for the demos. One demo (master or slave) is compiled for the host against
+   host/msp430.h and runs on the simulator in host/sim.c; its eUSCI_B0 drives SCL and SDA edge by edge: START,
+   address, data, ACK/NACK, repeated START, STOP and clock stretching. The other end of the bus is a behavioral
+   device in this file: a Demo6-like 10-byte slave when the firmware is a master, or a master that writes N bytes and
+   reads them back every period when the firmware is a slave. Both lines, the line drivers, CPU activity and port
+   outputs are written to a VCD file for GTKWave or PulseView.
+   The monitor decodes every transaction from the lines and reports duration, SCL stretching (SCL held low by the
+   slave after the master released it), firmware stall (eUSCI holding SCL until TXBUF is written or RXBUF read),
+   SCL low time at byte boundaries and dead time between a STOP and the next START.
+   Build:  gcc -O2 -Wall -rdynamic -Ihost -Dmain=fw_main -Wno-unknown-pragmas -o busmodel host/i2c_busmodel.c
+               host/sim.c Demo6_Master.c -ldl
+   Usage:  busmodel [options]
+             -o file.vcd   Waveform output
+             -t ms         Simulated time (default 3000)
+             -m Hz         MCLK/SMCLK (default 1000000)     -A Hz   ACLK (default 10000)
+             -c cycles     MCLK cycles per register access (default 4)
+             -i VEC=func   ISR name for a vector (TIMER0_B0, USCI_B0, TIMER0_A0, TIMER1_A0)
+             -a addr       Address of the behavioral slave, or target of the behavioral master (default 0x77)
+             -s us         Slave: stretch SCL after every byte   -r us   Slave: stretch before the first read byte
+             -b kHz        Master: bus rate (default 100)   -p ms   period (default 2000)   -n bytes (default 10)
+             -v            Print every transaction
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+#undef main
+
+#define MEMSIZE 10
+
+static int Verbose;
+static unsigned PeerAddr = 0x77, Length = 10;
+static uint64_t StretchByte, StretchRead, Period = 2000000000ULL;
+static double Rate = 100e3;
+
+/* ---- Behavioral slave ---- */
+
+static struct i2c_slave PS;
+static uint8_t Mem[MEMSIZE] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+static unsigned MemIdx;
+
+static int ps_match(struct i2c_slave *s, uint8_t a)
+{
+    if ((a >> 1) != PeerAddr) return 0;
+    MemIdx = 0;
+    if (a & 1) s->hold = StretchRead;
+    return 1;
+}
+
+static int ps_rx(struct i2c_slave *s, uint8_t b)
+{
+    Mem[MemIdx++ % MEMSIZE] = b;
+    s->hold = StretchByte;
+    return 1;
+}
+
+static int ps_tx(struct i2c_slave *s, uint8_t *b)
+{
+    *b = Mem[MemIdx++ % MEMSIZE];
+    if (MemIdx > 1) s->hold = StretchByte;
+    return 1;
+}
+
+static void ps_event(struct i2c_slave *s, int ev) { (void)s; (void)ev; }
+
+/* ---- Behavioral master: write Length bytes, read them back, every Period ---- */
+
+enum { PM_WAIT, PM_WRITE, PM_READ };
+static struct i2c_master PM;
+static int Phase, Go, Abort;
+static unsigned Sent, Got;
+static uint8_t TxBuf[256], RxBuf[256], Toggle;
+static uint64_t NextRun;
+
+static int pm_want_start(struct i2c_master *m) { (void)m; return Go; }
+static int pm_want_stop(struct i2c_master *m) { (void)m; return Abort || (Phase == PM_WRITE ? Sent >= Length : Got >= Length); }
+static uint8_t pm_address(struct i2c_master *m) { (void)m; return (PeerAddr << 1) | (Phase == PM_READ); }
+static int pm_rx_free(struct i2c_master *m) { (void)m; return 1; }
+static void pm_rx(struct i2c_master *m, uint8_t b) { (void)m; RxBuf[Got++ & 0xFF] = b; }
+
+static int pm_tx(struct i2c_master *m, uint8_t *b)
+{
+    (void)m;
+    if (Sent >= Length) return 0;
+    *b = TxBuf[Sent++];
+    return 1;
+}
+
+static void pm_event(struct i2c_master *m, int ev)
+{
+    (void)m;
+    switch (ev)
+    {
+    case M_EV_START: Go = 0; Sent = Got = 0; break;
+    case M_EV_NACK: Abort = 1; break;
+    case M_EV_STOP:
+        if (Phase == PM_WRITE && !Abort)
+        {
+            Phase = PM_READ;
+            Go = 1;
+        }
+        else
+        {
+            if (Phase == PM_READ && Verbose && Length > 2)
+                printf("%12.6f ms  master read back byte 3 = 0x%02X\n", SimNow / 1e6, RxBuf[2]);
+            Phase = PM_WAIT;
+        }
+        break;
+    }
+}
+
+/* ---- Peer: slave or master, opposite to the firmware ---- */
+
+static uint64_t peer_next(void)
+{
+    uint64_t t = SIM_NEVER;
+    if (sim_fw_role() == 1) t = PS.wake;
+    else if (sim_fw_role() == 2)
+    {
+        t = PM.wake;
+        if (Phase == PM_WAIT && NextRun < t) t = NextRun;
+    }
+    return t;
+}
+
+static void peer_run(void)
+{
+    unsigned i;
+    if (sim_fw_role() == 1)
+    {
+        if (SimNow >= PS.wake) i2c_slave_step(&PS);
+        return;
+    }
+    if (Phase == PM_WAIT && SimNow >= NextRun)
+    {
+        NextRun = SimNow + Period;
+        Toggle ^= 1;
+        for (i = 0; i < Length; i++) TxBuf[i] = i + 1;
+        if (Length > 2) TxBuf[2] = Toggle ? 0x07 : 0x03;
+        Phase = PM_WRITE;
+        Go = 1;
+        Abort = 0;
+        i2c_master_step(&PM);
+    }
+    else if (SimNow >= PM.wake) i2c_master_step(&PM);
+}
+
+static void monitor_edge(int scl, int sda, int old_scl, int old_sda);
+
+static void peer_edge(int scl, int sda, int old_scl, int old_sda)
+{
+    monitor_edge(scl, sda, old_scl, old_sda);
+    if (sim_fw_role() == 1) i2c_slave_edge(&PS, scl, sda, old_scl, old_sda);
+    else if (sim_fw_role() == 2) i2c_master_edge(&PM);
+}
+
+static const sim_peer_t Peer = { peer_next, peer_run, peer_edge };
+
+/* ---- Monitor ---- */
+
+struct stat { uint64_t n; double sum, min, max; };
+
+static void stat_add(struct stat *s, double v)
+{
+    if (!s->n || v < s->min) s->min = v;
+    if (!s->n || v > s->max) s->max = v;
+    s->sum += v;
+    s->n++;
+}
+
+static void stat_print(const char *name, struct stat *s)
+{
+    if (!s->n) printf("  %-28s      -\n", name);
+    else printf("  %-28s %10.2f %10.2f %10.2f us  (%llu)\n", name, s->min / 1e3, s->sum / s->n / 1e3, s->max / 1e3,
+                (unsigned long long)s->n);
+}
+
+static struct stat Dur, Dead, Stretch, Stall, LowBoundary, LowBit;
+static uint64_t Transactions, Bytes, Nacks, Restarts;
+static uint64_t TotalStretch, TotalStall, BusyTime;
+
+static int InXfer, ByRestart, Bit, SawBit, First;
+static uint8_t Shift, AddrByte;
+static uint64_t XStart, LastStop, SclFell, StretchSince, StallSince, XStretch, XStall;
+static unsigned XBytes, XNacks;
+static int Stretching, Stalling, VXfer, VByte;
+
+static void xfer_end(int restart)
+{
+    double d = SimNow - XStart;
+    stat_add(&Dur, d);
+    stat_add(&Stretch, XStretch);
+    stat_add(&Stall, XStall);
+    BusyTime += SimNow - XStart;
+    Transactions++;
+    if (Verbose)
+        printf("%12.6f ms  %s 0x%02X %c %3u bytes %s  %9.2f us  stretch %8.2f us  stall %8.2f us%s\n", XStart / 1e6,
+               ByRestart ? "Sr" : "S ", AddrByte >> 1, (AddrByte & 1) ? 'R' : 'W', XBytes, XNacks ? "NACK" : "ACK ",
+               d / 1e3, XStretch / 1e3, XStall / 1e3, restart ? "  Sr" : "  P");
+}
+
+static void xfer_begin(int restart)
+{
+    ByRestart = restart;
+    XStart = SimNow;
+    XBytes = XNacks = 0;
+    XStretch = XStall = 0;
+    Bit = 0;
+    SawBit = 0;
+    First = 1;
+    InXfer = 1;
+    sim_vcd_set(VXfer, 1);
+}
+
+static void monitor_edge(int scl, int sda, int old_scl, int old_sda)
+{
+    if (scl && old_scl && !sda && old_sda) //START
+    {
+        if (InXfer)
+        {
+            Restarts++;
+            xfer_end(1);
+        }
+        else if (LastStop) stat_add(&Dead, SimNow - LastStop);
+        xfer_begin(InXfer);
+        return;
+    }
+    if (scl && old_scl && sda && !old_sda) //STOP
+    {
+        if (InXfer) xfer_end(0);
+        InXfer = 0;
+        sim_vcd_set(VXfer, 0);
+        LastStop = SimNow;
+        return;
+    }
+    if (!InXfer) return;
+    if (!scl && old_scl) SclFell = SimNow;
+    if (!scl || old_scl) return;
+    //SCL rose: length of the low phase, then the bit
+    if (SawBit) stat_add(Bit == 0 ? &LowBoundary : &LowBit, SimNow - SclFell);
+    SawBit = 1;
+    if (Bit < 8)
+    {
+        Shift = (Shift << 1) | sda;
+        Bit++;
+        return;
+    }
+    Bit = 0; //ACK clock
+    sim_vcd_set(VByte, Shift);
+    if (sda) { XNacks++; Nacks++; }
+    if (First)
+    {
+        AddrByte = Shift;
+        First = 0;
+    }
+    else { XBytes++; Bytes++; }
+}
+
+static void monitor_watch(void)
+{
+    int master = sim_fw_role() == 1 ? SIM_FW : SIM_PEER;
+    int stretching = sim_fw_role() && !sim_driving_scl(master) && sim_driving_scl(!master);
+    int stalling = sim_fw_stalled();
+    if (stretching != Stretching)
+    {
+        if (Stretching) { XStretch += SimNow - StretchSince; TotalStretch += SimNow - StretchSince; }
+        StretchSince = SimNow;
+        Stretching = stretching;
+    }
+    if (stalling != Stalling)
+    {
+        if (Stalling) { XStall += SimNow - StallSince; TotalStall += SimNow - StallSince; }
+        StallSince = SimNow;
+        Stalling = stalling;
+    }
+}
+
+static void report(void)
+{
+    monitor_watch();
+    if (Stretching) XStretch += SimNow - StretchSince, TotalStretch += SimNow - StretchSince;
+    if (Stalling) XStall += SimNow - StallSince, TotalStall += SimNow - StallSince;
+    if (InXfer)
+        printf("%12.6f ms  transaction to 0x%02X still open at the end: SCL %s, SDA %s, stretch %.2f us, stall %.2f us\n",
+               XStart / 1e6, AddrByte >> 1, sim_scl() ? "high" : "low", sim_sda() ? "high" : "low", XStretch / 1e3,
+               XStall / 1e3);
+    printf("\n%llu transactions (%llu repeated starts), %llu data bytes, %llu NACKs in %.3f ms; bus busy %.2f%%\n",
+           (unsigned long long)Transactions, (unsigned long long)Restarts, (unsigned long long)Bytes,
+           (unsigned long long)Nacks, SimNow / 1e6, SimNow ? 100.0 * BusyTime / SimNow : 0);
+    printf("  %-28s %10s %10s %10s\n", "", "min", "avg", "max");
+    stat_print("Transaction (START-STOP/Sr)", &Dur);
+    stat_print("Dead time (STOP-START)", &Dead);
+    stat_print("SCL low within a byte", &LowBit);
+    stat_print("SCL low at byte boundary", &LowBoundary);
+    stat_print("Stretch per transaction", &Stretch);
+    stat_print("Stall per transaction", &Stall);
+    printf("  Total stretch %.2f us, total firmware stall %.2f us\n", TotalStretch / 1e3, TotalStall / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    int c;
+    while ((c = getopt(argc, argv, "o:t:m:A:c:i:a:s:r:b:p:n:v")) != -1)
+    {
+        switch (c)
+        {
+        case 'o':
+            if (sim_vcd_open(optarg)) { perror(optarg); return 1; }
+            break;
+        case 't': SimEnd = (uint64_t)(atof(optarg) * 1e6); break;
+        case 'm': SimMclk = atof(optarg); break;
+        case 'A': SimAclk = atof(optarg); break;
+        case 'c': SimAccessCycles = atoi(optarg); break;
+        case 'i':
+            if (sim_vector(optarg)) { fprintf(stderr, "unknown vector in %s\n", optarg); return 1; }
+            break;
+        case 'a': PeerAddr = strtoul(optarg, 0, 0) & 0x7F; break;
+        case 's': StretchByte = (uint64_t)(atof(optarg) * 1e3); break;
+        case 'r': StretchRead = (uint64_t)(atof(optarg) * 1e3); break;
+        case 'b': Rate = atof(optarg) * 1e3; break;
+        case 'p': Period = (uint64_t)(atof(optarg) * 1e6); break;
+        case 'n': Length = atoi(optarg) & 0xFF; break;
+        case 'v': Verbose = 1; break;
+        default: fprintf(stderr, "see the header of i2c_busmodel.c for the options\n"); return 1;
+        }
+    }
+    PS = (struct i2c_slave){ .dev = SIM_PEER, .wake = SIM_NEVER, .match = ps_match, .rx = ps_rx, .tx = ps_tx,
+        .event = ps_event };
+    PM = (struct i2c_master){ .dev = SIM_PEER, .half = (uint64_t)(1e9 / Rate / 2), .wake = SIM_NEVER,
+        .want_start = pm_want_start, .want_stop = pm_want_stop, .address = pm_address, .tx = pm_tx,
+        .rx_free = pm_rx_free, .rx = pm_rx, .event = pm_event };
+    NextRun = Period / 10;
+    VXfer = sim_vcd_var("transaction", 1);
+    VByte = sim_vcd_var("byte", 8);
+    sim_set_peer(&Peer);
+    SimWatch = monitor_watch;
+    SimAtEnd = report;
+    sim_start();
+    return 0;
+}
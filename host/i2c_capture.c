@@ -0,0 +1,215 @@
+/* Host side of the I2C to UART bridge (Demo10_Master.c). Reads the packet stream from a serial port, pty or
+   capture file, checks framing and checksums, and reports throughput and dropped packets.
+   A sequence gap means the master dropped packets because its TX ring was full; a bad checksum or lost sync
+   means bytes were corrupted or lost on the UART. Packets rejected by the checksum also show up as a sequence gap.
+   Build:  gcc -O2 -Wall -o i2c_capture host/i2c_capture.c
+   Usage:  i2c_capture <device|file> [baud]      e.g. i2c_capture /dev/ttyACM0 115200
+           Serial devices are set to raw 8N1 at the given baud (default 115200). Files are read to the end.
+           Payloads are printed with -v as the first argument.
+*/
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SYNC0 0xA5
+#define SYNC1 0x5A
+#define HEADER 8 //Sync, Seq, Len, Time
+#define MAXLEN 255
+#define VLO_HZ 10000.0 //Nominal tick rate of the master timestamp
+
+static volatile sig_atomic_t Stop;
+
+struct stats {
+    uint64_t packets, payload_bytes, stream_bytes;
+    uint64_t dropped, bad_check, resync_bytes;
+    uint32_t first_time, last_time;
+    int have_seq;
+    uint8_t last_seq;
+};
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    Stop = 1;
+}
+
+static speed_t baud_flag(long baud)
+{
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    default: return 0;
+    }
+}
+
+//Put a tty into raw 8N1 mode; anything that is not a tty (file, pipe) is left alone
+static int setup_tty(int fd, long baud)
+{
+    struct termios t;
+    speed_t speed;
+
+    if (!isatty(fd))
+        return 0;
+    speed = baud_flag(baud);
+    if (!speed) {
+        fprintf(stderr, "unsupported baud %ld\n", baud);
+        return -1;
+    }
+    if (tcgetattr(fd, &t) < 0)
+        return -1;
+    cfmakeraw(&t);
+    t.c_cflag |= CLOCAL | CREAD;
+    t.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    t.c_cc[VMIN] = 1;
+    t.c_cc[VTIME] = 0;
+    cfsetispeed(&t, speed);
+    cfsetospeed(&t, speed);
+    return tcsetattr(fd, TCSANOW, &t);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const struct stats *s, double elapsed)
+{
+    double device = (uint32_t)(s->last_time - s->first_time) / VLO_HZ;
+
+    printf("packets %llu  payload %llu B  seq gaps %llu  bad checksum %llu  resync %llu B\n",
+           (unsigned long long)s->packets, (unsigned long long)s->payload_bytes,
+           (unsigned long long)s->dropped, (unsigned long long)s->bad_check,
+           (unsigned long long)s->resync_bytes);
+    if (elapsed > 0)
+        printf("host:   %.1f packets/s  %.1f payload B/s  %.1f stream B/s\n",
+               s->packets / elapsed, s->payload_bytes / elapsed, s->stream_bytes / elapsed);
+    if (s->packets > 1 && device > 0)
+        printf("device: %.1f packets/s over %.2f s of timestamps\n", (s->packets - 1) / device, device);
+    fflush(stdout);
+}
+
+//Account for one complete, checksummed packet
+static void packet(struct stats *s, const uint8_t *p, int verbose)
+{
+    uint8_t seq = p[2], len = p[3];
+    uint32_t time = p[4] | (uint32_t)p[5] << 8 | (uint32_t)p[6] << 16 | (uint32_t)p[7] << 24;
+    int i;
+
+    if (s->have_seq)
+        s->dropped += (uint8_t)(seq - s->last_seq - 1);
+    else
+        s->first_time = time;
+    s->have_seq = 1;
+    s->last_seq = seq;
+    s->last_time = time;
+    s->packets++;
+    s->payload_bytes += len;
+    if (verbose) {
+        printf("%3u %10u:", seq, time);
+        for (i = 0; i < len; i++)
+            printf(" %02x", p[HEADER + i]);
+        printf("\n");
+    }
+}
+
+//Add one stream byte to the frame being assembled in buf; returns the new number of bytes held
+static int feed(struct stats *s, uint8_t *buf, int have, uint8_t b, int verbose)
+{
+    uint8_t rest[HEADER + MAXLEN];
+    uint8_t sum = 0;
+    int k, n;
+
+    buf[have++] = b;
+    //Hunt for the two sync bytes, discarding anything in between
+    if (have == 1 && buf[0] != SYNC0) {
+        s->resync_bytes++;
+        return 0;
+    }
+    if (have == 2 && buf[1] != SYNC1) {
+        s->resync_bytes++;
+        buf[0] = buf[1];
+        return buf[0] == SYNC0;
+    }
+    if (have < HEADER || have != HEADER + buf[3] + 1)
+        return have;
+    for (k = 2; k < have; k++)
+        sum += buf[k];
+    if (sum == 0) {
+        packet(s, buf, verbose);
+        return 0;
+    }
+    //Bad checksum, possibly a corrupted length: drop only the first sync byte and rescan the rest,
+    //so valid frames that were swallowed into this one are still found
+    s->bad_check++;
+    s->resync_bytes++;
+    n = have - 1;
+    memcpy(rest, buf + 1, n);
+    have = 0;
+    for (k = 0; k < n; k++)
+        have = feed(s, buf, have, rest[k], verbose);
+    return have;
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t buf[HEADER + MAXLEN + 1], in[4096];
+    struct stats s;
+    int fd, verbose = 0, have = 0, i;
+    long baud = 115200;
+    double start, last_report;
+    ssize_t n;
+
+    if (argc > 1 && !strcmp(argv[1], "-v")) {
+        verbose = 1;
+        argv++;
+        argc--;
+    }
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s [-v] <device|file> [baud]\n", argv[0]);
+        return 2;
+    }
+    if (argc > 2)
+        baud = strtol(argv[2], NULL, 10);
+    fd = open(argv[1], O_RDONLY | O_NOCTTY);
+    if (fd < 0 || setup_tty(fd, baud) < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    signal(SIGINT, on_signal);
+    memset(&s, 0, sizeof(s));
+    start = last_report = now();
+
+    while (!Stop) {
+        n = read(fd, in, sizeof(in));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        s.stream_bytes += n;
+        for (i = 0; i < n; i++)
+            have = feed(&s, buf, have, in[i], verbose);
+        if (now() - last_report >= 1.0 && isatty(fd)) {
+            last_report = now();
+            report(&s, last_report - start);
+        }
+    }
+    report(&s, now() - start);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,474 @@
+/* Replays I2C traffic captured with a logic analyzer into a slave demo built for the host (see
+   host/i2c_busmodel.c for the build). The capture is the CSV export of an I2C protocol decoder; each recorded
+   transaction is sent by a bit-level master at its recorded time (or accelerated), against the slave firmware's
+   ISRs and main loop running on host/sim.c. For every transaction the tool reports when it actually started
+   (later than recorded if the slave was still stretching the previous one, earlier for a repeated START after a
+   part that ran faster than recorded, which shows as a negative lag), its duration, the SCL stretch caused by the
+   slave and the longest single stretch. Divergence from the capture is reported byte by byte: a different
+   ACK/NACK from the slave on the address or written data, or different data returned on a read.
+   Accepted CSV layouts (the header line selects the layout; the first is also accepted without a header):
+     time,event,value,ack                     event is start, stop, address or data; address value is the 8-bit
+                                              address byte with R/W in bit 0; ack is ACK/NAK
+     name,type,start_time,duration,ack,address,read,data      Saleae Logic 2 I2C export
+     Time [s],Packet ID,Address,Data,Read/Write,ACK/NAK       Saleae Logic 1.x I2C export
+   Build:  gcc -O2 -Wall -rdynamic -Ihost -Dmain=fw_main -Wno-unknown-pragmas -o replay host/i2c_replay.c
+               host/sim.c Demo6_Slave.c -ldl
+           Add -g -fsanitize=address to stop at the first write past a firmware buffer, e.g. RxData in
+           Demo5_Slave.c when the capture writes more bytes than it holds.
+   Usage:  replay [options] capture.csv
+             -x factor     Replay speed: 1 = recorded timing (default), 10 = ten times faster gaps,
+                           0 = transactions back to back
+             -b kHz        Bus rate (default: from the capture when it has frame durations, else 100)
+             -T ms         Give up when the slave holds SCL low this long (default 25)
+             -o file.vcd   Waveform output
+             -m Hz, -A Hz, -c cycles, -i VEC=func     As for i2c_busmodel
+             -v            Print every transaction, not only the ones that diverge
+*/
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+#undef main
+
+#define MAXBYTES 256
+#define MAXFIELDS 16
+#define OFFSET 10000000ULL //Firmware start-up time before the first transaction, ns
+
+struct xfer {
+    double time, end; //Recorded START and STOP (or repeated START), s
+    uint8_t addr, addr_ack, restart; //restart: begins with a repeated START
+    unsigned n;
+    uint8_t data[MAXBYTES], ack[MAXBYTES]; //Written or recorded read data; ACK of each byte
+};
+
+static struct xfer *X;
+static unsigned NX, Cap;
+static double Speed = 1, Rate, FrameSum;
+static unsigned Frames;
+static int Verbose;
+static uint64_t Timeout = 25000000ULL;
+
+/* ---- Capture import ---- */
+
+static int split(char *line, char **f)
+{
+    int n = 0, sep;
+    char *p = line, *o;
+    while (n < MAXFIELDS)
+    {
+        while (*p == ' ' || *p == '\t') p++;
+        f[n++] = o = p;
+        if (*p == '"')
+        {
+            p++;
+            while (*p && !(*p == '"' && p[1] != '"')) { if (*p == '"') p++; *o++ = *p++; }
+            if (*p) p++;
+        }
+        else while (*p && *p != ',' && *p != '\r' && *p != '\n') *o++ = *p++;
+        while (*p && *p != ',') p++;
+        sep = *p;
+        *o = 0; //May overwrite the separator, so it is tested from sep
+        if (sep != ',') break;
+        p++;
+    }
+    return n;
+}
+
+static int column(char **f, int n, const char *name)
+{
+    int i;
+    char *c;
+    for (i = 0; i < n; i++)
+    {
+        for (c = f[i]; *c; c++) *c = tolower((unsigned char)*c);
+        if (!strcmp(f[i], name)) return i;
+    }
+    return -1;
+}
+
+static int is_ack(const char *s)
+{
+    return !strcasecmp(s, "ack") || !strcasecmp(s, "true") || !strcmp(s, "1");
+}
+
+static struct xfer *new_xfer(double t, int restart)
+{
+    if (NX == Cap)
+    {
+        Cap = Cap ? 2 * Cap : 64;
+        X = realloc(X, Cap * sizeof *X);
+        if (!X) { perror("realloc"); exit(1); }
+    }
+    memset(&X[NX], 0, sizeof *X);
+    X[NX].time = X[NX].end = t;
+    X[NX].restart = restart;
+    X[NX].addr_ack = 1;
+    return &X[NX++];
+}
+
+static void add_byte(struct xfer *x, uint8_t b, int ack)
+{
+    if (x->n == MAXBYTES) return;
+    x->data[x->n] = b;
+    x->ack[x->n++] = ack;
+}
+
+static int load(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    char line[512], hdr[512], *f[MAXFIELDS];
+    int n, layout, ctime = -1, ctype, cack = -1, caddr = -1, cread = -1, cdata = -1, cdur = -1, cpkt, crw = -1, open = 0;
+    long pkt = -1;
+    struct xfer *x = 0;
+    const char *ev, *val, *ack;
+    double t;
+    if (!in) { perror(path); return -1; }
+    if (!fgets(hdr, sizeof hdr, in)) { fclose(in); return -1; }
+    strcpy(line, hdr);
+    n = split(hdr, f);
+    ctype = column(f, n, "type");
+    cpkt = column(f, n, "packet id");
+    if (ctype >= 0)
+    {
+        layout = 2;
+        ctime = column(f, n, "start_time");
+        cdur = column(f, n, "duration");
+        cack = column(f, n, "ack");
+        caddr = column(f, n, "address");
+        cread = column(f, n, "read");
+        cdata = column(f, n, "data");
+        if (ctime < 0 || cack < 0 || caddr < 0 || cread < 0 || cdata < 0) goto bad;
+    }
+    else if (cpkt >= 0)
+    {
+        layout = 1;
+        ctime = column(f, n, "time [s]");
+        caddr = column(f, n, "address");
+        cdata = column(f, n, "data");
+        crw = column(f, n, "read/write");
+        cack = column(f, n, "ack/nak");
+        if (ctime < 0 || caddr < 0 || cdata < 0 || crw < 0 || cack < 0) goto bad;
+    }
+    else
+    {
+        layout = 0;
+        if (!isdigit((unsigned char)*f[0]) && *f[0] != '.') line[0] = 0; //Header line, skip it
+    }
+    do
+    {
+        if (!line[0]) continue;
+        n = split(line, f);
+        if (layout == 1)
+        {
+            if (n <= cack) continue;
+            t = atof(f[ctime]);
+            if (atol(f[cpkt]) != pkt || !x)
+            {
+                pkt = atol(f[cpkt]);
+                x = new_xfer(t, 0);
+                x->addr = (strtoul(f[caddr], 0, 0) << 1) | (tolower((unsigned char)*f[crw]) == 'r');
+            }
+            if (*f[cdata]) add_byte(x, strtoul(f[cdata], 0, 0), is_ack(f[cack]));
+            x->end = t;
+            continue;
+        }
+        if (layout == 2)
+        {
+            if (n <= cdata) continue;
+            ev = f[ctype];
+            t = atof(f[ctime]);
+            ack = f[cack];
+            val = !strcasecmp(ev, "address") ? f[caddr] : f[cdata];
+            if (cdur >= 0 && !strcasecmp(ev, "data") && atof(f[cdur]) > 0)
+            {
+                FrameSum += atof(f[cdur]);
+                Frames++;
+            }
+        }
+        else
+        {
+            if (n < 2) continue;
+            t = atof(f[0]);
+            ev = f[1];
+            val = n > 2 ? f[2] : "";
+            ack = n > 3 ? f[3] : "";
+        }
+        if (!strcasecmp(ev, "start"))
+        {
+            if (x && open) x->end = t;
+            x = new_xfer(t, open);
+            open = 1;
+        }
+        else if (!strcasecmp(ev, "stop"))
+        {
+            if (x) x->end = t;
+            open = 0;
+        }
+        else if (!x) continue;
+        else if (!strcasecmp(ev, "address"))
+        {
+            x->addr = layout == 2 ? (strtoul(val, 0, 0) << 1) | is_ack(f[cread]) : strtoul(val, 0, 0);
+            x->addr_ack = is_ack(ack);
+        }
+        else if (!strcasecmp(ev, "data")) add_byte(x, strtoul(val, 0, 0), is_ack(ack));
+    } while (fgets(line, sizeof line, in));
+    fclose(in);
+    return 0;
+bad:
+    fprintf(stderr, "%s: missing columns in the header\n", path);
+    fclose(in);
+    return -1;
+}
+
+/* ---- Replay master ---- */
+
+static struct i2c_master RM;
+static unsigned Next, Cur, Sent, Got;
+static int Active, Abort;
+static uint64_t Done = SIM_NEVER;
+
+static uint64_t sched(unsigned i)
+{
+    return OFFSET + (Speed > 0 ? (uint64_t)((X[i].time - X[0].time) / Speed * 1e9) : 0);
+}
+
+static int cur_done(void)
+{
+    struct xfer *x = &X[Cur];
+    return Abort || !x->addr_ack || ((x->addr & 1) ? Got >= x->n : Sent >= x->n);
+}
+
+static int rm_want_start(struct i2c_master *m)
+{
+    (void)m;
+    if (Next >= NX) return 0;
+    if (Active) return X[Next].restart && cur_done();
+    return SimNow >= sched(Next);
+}
+
+static int rm_want_stop(struct i2c_master *m)
+{
+    (void)m;
+    return Active && cur_done() && !(Next < NX && X[Next].restart);
+}
+
+static uint8_t rm_address(struct i2c_master *m) { (void)m; return X[Next].addr; }
+static int rm_rx_free(struct i2c_master *m) { (void)m; return 1; }
+
+static int rm_tx(struct i2c_master *m, uint8_t *b)
+{
+    struct xfer *x = &X[Cur];
+    (void)m;
+    if ((x->addr & 1) || Sent >= x->n) return 0;
+    *b = x->data[Sent++];
+    return 1;
+}
+
+/* ---- Measurement ---- */
+
+struct stat { uint64_t n; double sum, min, max; };
+
+static void stat_add(struct stat *s, double v)
+{
+    if (!s->n || v < s->min) s->min = v;
+    if (!s->n || v > s->max) s->max = v;
+    s->sum += v;
+    s->n++;
+}
+
+static void stat_print(const char *name, struct stat *s)
+{
+    if (!s->n) printf("  %-26s      -\n", name);
+    else printf("  %-26s %10.2f %10.2f %10.2f us\n", name, s->min / 1e3, s->sum / s->n / 1e3, s->max / 1e3);
+}
+
+static struct stat Lag, Dur, Stretch, MaxStretch, Slower;
+static unsigned Replayed, Diverged, Divergences;
+static uint64_t XStart, XStretch, XMaxStretch, StretchSince;
+static int Stretching, XDiff, VDiverge, VIndex;
+static char XNote[160];
+
+static void diverge(const char *fmt, ...)
+{
+    va_list ap;
+    Divergences++;
+    sim_vcd_set(VDiverge, 1);
+    if (XDiff++) return; //Only the first difference of a transaction is shown
+    va_start(ap, fmt);
+    vsnprintf(XNote, sizeof XNote, fmt, ap);
+    va_end(ap);
+}
+
+static void stretch_end(void)
+{
+    uint64_t d = SimNow - StretchSince;
+    XStretch += d;
+    if (d > XMaxStretch) XMaxStretch = d;
+}
+
+static void rm_rx(struct i2c_master *m, uint8_t b)
+{
+    struct xfer *x = &X[Cur];
+    (void)m;
+    if (Got < x->n && b != x->data[Got]) diverge("read byte %u: 0x%02X, recorded 0x%02X", Got + 1, b, x->data[Got]);
+    Got++;
+}
+
+static void xfer_end(void)
+{
+    struct xfer *x = &X[Cur];
+    double d = SimNow - XStart, rec = (x->end - x->time) * 1e9;
+    double lag = (int64_t)(XStart - sched(Cur)); //Negative when a repeated START comes earlier than recorded
+    if (Stretching) //Stretch running into a repeated START
+    {
+        stretch_end();
+        StretchSince = SimNow;
+    }
+    stat_add(&Lag, lag);
+    stat_add(&Dur, d);
+    stat_add(&Stretch, XStretch);
+    stat_add(&MaxStretch, XMaxStretch);
+    if (rec > 0) stat_add(&Slower, d - rec);
+    Replayed++;
+    if (XDiff) Diverged++;
+    if (Verbose || XDiff)
+        printf("%5u %12.6f ms  %s0x%02X %c %3u  lag %9.2f us  %9.2f us (rec %9.2f)  stretch %8.2f max %8.2f us  %s\n",
+               Cur + 1, XStart / 1e6, x->restart ? "Sr " : "S  ", x->addr >> 1, (x->addr & 1) ? 'R' : 'W', x->n,
+               lag / 1e3, d / 1e3, rec / 1e3, XStretch / 1e3, XMaxStretch / 1e3,
+               XDiff ? XNote : "ok");
+    Active = 0;
+    sim_vcd_set(VDiverge, 0);
+}
+
+static void rm_event(struct i2c_master *m, int ev)
+{
+    struct xfer *x = &X[Cur];
+    switch (ev)
+    {
+    case M_EV_START:
+        if (Active) xfer_end();
+        Cur = Next++;
+        Active = 1;
+        Abort = 0;
+        Sent = Got = 0;
+        XStart = SimNow;
+        XStretch = XMaxStretch = 0;
+        XDiff = 0;
+        sim_vcd_set(VIndex, Cur + 1);
+        break;
+    case M_EV_ADDR_ACK:
+        if (!x->addr_ack) diverge("address ACKed, recorded NACK");
+        break;
+    case M_EV_NACK:
+        if (!m->bytes && x->addr_ack) diverge("address NACKed, recorded ACK");
+        else if (m->bytes && (unsigned)m->bytes <= x->n && x->ack[m->bytes - 1])
+            diverge("write byte %u NACKed, recorded ACK", m->bytes);
+        Abort = 1;
+        break;
+    case M_EV_BYTE:
+        if (!(x->addr & 1) && m->ack && (unsigned)m->bytes <= x->n && !x->ack[m->bytes - 1])
+            diverge("write byte %u ACKed, recorded NACK", m->bytes);
+        break;
+    case M_EV_STOP:
+        xfer_end();
+        if (Next >= NX) Done = SimNow + 1000000; //Let the slave finish for 1 ms
+        break;
+    }
+}
+
+static void watch(void)
+{
+    int stretching = !sim_driving_scl(SIM_PEER) && sim_driving_scl(SIM_FW);
+    if (stretching == Stretching) return;
+    if (Stretching && Active) stretch_end();
+    StretchSince = SimNow;
+    Stretching = stretching;
+}
+
+/* ---- Peer ---- */
+
+static uint64_t peer_next(void)
+{
+    uint64_t t = RM.wake;
+    if (!Active && Next < NX && sched(Next) > SimNow && sched(Next) < t) t = sched(Next); //Past: started from M_BUF
+    if (Stretching && StretchSince + Timeout < t) t = StretchSince + Timeout;
+    if (Done < t) t = Done;
+    return t;
+}
+
+static void peer_run(void)
+{
+    if (SimNow >= Done) sim_finish("capture replayed");
+    if (Stretching && SimNow >= StretchSince + Timeout)
+    {
+        printf("%5u %12.6f ms  slave has held SCL low for %.1f ms, giving up\n", Cur + 1, SimNow / 1e6,
+               (SimNow - StretchSince) / 1e6);
+        sim_finish("slave stuck");
+    }
+    i2c_master_step(&RM);
+}
+
+static void peer_edge(int scl, int sda, int old_scl, int old_sda)
+{
+    (void)scl; (void)sda; (void)old_scl; (void)old_sda;
+    i2c_master_edge(&RM);
+}
+
+static const sim_peer_t Peer = { peer_next, peer_run, peer_edge };
+
+static void report(void)
+{
+    printf("\n%u of %u transactions replayed at %.0f kHz, speed %g; %u diverged (%u differences)\n",
+           Replayed, NX, Rate / 1e3, Speed, Diverged, Divergences);
+    printf("  %-26s %10s %10s %10s\n", "", "min", "avg", "max");
+    stat_print("Start lag behind capture", &Lag);
+    stat_print("Transaction time", &Dur);
+    stat_print("Replayed minus recorded", &Slower);
+    stat_print("Stretch per transaction", &Stretch);
+    stat_print("Longest single stretch", &MaxStretch);
+}
+
+int main(int argc, char **argv)
+{
+    int c;
+    while ((c = getopt(argc, argv, "x:b:T:o:m:A:c:i:v")) != -1)
+    {
+        switch (c)
+        {
+        case 'x': Speed = atof(optarg); break;
+        case 'b': Rate = atof(optarg) * 1e3; break;
+        case 'T': Timeout = (uint64_t)(atof(optarg) * 1e6); break;
+        case 'o':
+            if (sim_vcd_open(optarg)) { perror(optarg); return 1; }
+            break;
+        case 'm': SimMclk = atof(optarg); break;
+        case 'A': SimAclk = atof(optarg); break;
+        case 'c': SimAccessCycles = atoi(optarg); break;
+        case 'i':
+            if (sim_vector(optarg)) { fprintf(stderr, "unknown vector in %s\n", optarg); return 1; }
+            break;
+        case 'v': Verbose = 1; break;
+        default: fprintf(stderr, "see the header of i2c_replay.c for the options\n"); return 1;
+        }
+    }
+    if (optind >= argc) { fprintf(stderr, "usage: replay [options] capture.csv\n"); return 1; }
+    if (load(argv[optind])) return 1;
+    if (!NX) { fprintf(stderr, "%s: no transactions\n", argv[optind]); return 1; }
+    if (!Rate) Rate = Frames ? 9.0 * Frames / FrameSum : 100e3; //A data frame is 9 SCL periods
+    printf("%u transactions over %.3f s from %s\n", NX, X[NX - 1].end - X[0].time, argv[optind]);
+    RM = (struct i2c_master){ .dev = SIM_PEER, .half = (uint64_t)(1e9 / Rate / 2), .wake = SIM_NEVER,
+        .want_start = rm_want_start, .want_stop = rm_want_stop, .address = rm_address, .tx = rm_tx,
+        .rx_free = rm_rx_free, .rx = rm_rx, .event = rm_event };
+    SimEnd = sched(NX - 1) + (uint64_t)((X[NX - 1].end - X[NX - 1].time) * 1e9) + 10 * Timeout + 1000000000ULL;
+    VIndex = sim_vcd_var("transaction", 16);
+    VDiverge = sim_vcd_var("diverged", 1);
+    sim_set_peer(&Peer);
+    SimWatch = watch;
+    SimAtEnd = report;
+    sim_start();
+    return 0;
+}
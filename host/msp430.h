@@ -0,0 +1,399 @@
+/* Host stand-in for <msp430.h>, used to build the demo firmware on Linux against the bus model (host/sim.c).
+   Only for host builds: pass -Ihost so the demos pick it up instead of the TI header.
+   Every register is a location in the simulator. Each access goes through sim_reg(), which advances simulated
+   time by a few MCLK cycles, lets the eUSCI_B0 and timer models catch up and takes pending interrupts, so polling
+   loops such as while (UCB0CTLW0 & UCTXSTP) work as on the chip. Low power modes return to the simulator until
+   an ISR clears the LPM bits on exit. Bit values follow the TI headers; clock system and FRAM registers are plain
+   storage and do not change the simulated clocks (set them on the command line instead).
+*/
+#ifndef HOST_MSP430_H
+#define HOST_MSP430_H
+
+#include <stdint.h>
+
+enum {
+    R_WDTCTL, R_PM5CTL0, R_SFRIE1, R_SFRIFG1, R_SYSCFG0, R_FRCTL0,
+    R_CSCTL0, R_CSCTL1, R_CSCTL2, R_CSCTL3, R_CSCTL4, R_CSCTL5, R_CSCTL6, R_CSCTL7, R_CSCTL8,
+#define PORT_REGS(n) R_P##n##IN, R_P##n##OUT, R_P##n##DIR, R_P##n##REN, R_P##n##SEL0, R_P##n##SEL1, \
+    R_P##n##IES, R_P##n##IE, R_P##n##IFG
+    PORT_REGS(1), PORT_REGS(2), PORT_REGS(3), PORT_REGS(4), PORT_REGS(5), PORT_REGS(6),
+#define TIMER_REGS(t) R_##t##CTL, R_##t##CCTL0, R_##t##CCTL1, R_##t##CCTL2, R_##t##CCR0, R_##t##CCR1, \
+    R_##t##CCR2, R_##t##R, R_##t##EX0, R_##t##IV
+    TIMER_REGS(TA0), TIMER_REGS(TA1), TIMER_REGS(TB0),
+    R_UCB0CTLW0, R_UCB0CTLW1, R_UCB0BRW, R_UCB0STATW, R_UCB0TBCNT, R_UCB0RXBUF, R_UCB0TXBUF,
+    R_UCB0I2COA0, R_UCB0I2COA1, R_UCB0I2COA2, R_UCB0I2COA3, R_UCB0ADDRX, R_UCB0ADDMASK, R_UCB0I2CSA,
+    R_UCB0IE, R_UCB0IFG, R_UCB0IV,
+    R_COUNT
+};
+
+void *sim_reg(int id);
+void sim_sr_set(uint16_t bits);
+void sim_sr_clear(uint16_t bits);
+void sim_sr_set_on_exit(uint16_t bits);
+void sim_sr_clear_on_exit(uint16_t bits);
+uint16_t sim_sr(void);
+void sim_delay(uint32_t cycles);
+
+#define SIM_W(id) (*(volatile uint16_t *)sim_reg(id))
+#define SIM_L(id) (*(volatile uint8_t *)sim_reg(id))
+#define SIM_H(id) (*((volatile uint8_t *)sim_reg(id) + 1))
+
+/* Intrinsics */
+#define __interrupt
+#define __even_in_range(x, y) (x)
+#define __enable_interrupt() sim_sr_set(GIE)
+#define __disable_interrupt() sim_sr_clear(GIE)
+#define _enable_interrupts() sim_sr_set(GIE)
+#define _disable_interrupts() sim_sr_clear(GIE)
+#define __bis_SR_register(x) sim_sr_set(x)
+#define __bic_SR_register(x) sim_sr_clear(x)
+#define _BIS_SR(x) sim_sr_set(x)
+#define _BIC_SR(x) sim_sr_clear(x)
+#define __bis_SR_register_on_exit(x) sim_sr_set_on_exit(x)
+#define __bic_SR_register_on_exit(x) sim_sr_clear_on_exit(x)
+#define __get_SR_register() sim_sr()
+#define __delay_cycles(x) sim_delay(x)
+#define __no_operation() sim_delay(1)
+#define _NOP() sim_delay(1)
+
+/* Status register */
+#define GIE     0x0008
+#define CPUOFF  0x0010
+#define OSCOFF  0x0020
+#define SCG0    0x0040
+#define SCG1    0x0080
+#define LPM0_bits (CPUOFF)
+#define LPM1_bits (SCG0 + CPUOFF)
+#define LPM2_bits (SCG1 + CPUOFF)
+#define LPM3_bits (SCG1 + SCG0 + CPUOFF)
+#define LPM4_bits (SCG1 + SCG0 + OSCOFF + CPUOFF)
+#define LPM0 __bis_SR_register(LPM0_bits)
+#define LPM1 __bis_SR_register(LPM1_bits)
+#define LPM2 __bis_SR_register(LPM2_bits)
+#define LPM3 __bis_SR_register(LPM3_bits)
+#define LPM4 __bis_SR_register(LPM4_bits)
+#define LPM0_EXIT __bic_SR_register_on_exit(LPM0_bits)
+#define LPM1_EXIT __bic_SR_register_on_exit(LPM1_bits)
+#define LPM2_EXIT __bic_SR_register_on_exit(LPM2_bits)
+#define LPM3_EXIT __bic_SR_register_on_exit(LPM3_bits)
+#define LPM4_EXIT __bic_SR_register_on_exit(LPM4_bits)
+
+#define BIT0 0x0001
+#define BIT1 0x0002
+#define BIT2 0x0004
+#define BIT3 0x0008
+#define BIT4 0x0010
+#define BIT5 0x0020
+#define BIT6 0x0040
+#define BIT7 0x0080
+#define BIT8 0x0100
+#define BIT9 0x0200
+#define BITA 0x0400
+#define BITB 0x0800
+#define BITC 0x1000
+#define BITD 0x2000
+#define BITE 0x4000
+#define BITF 0x8000
+
+/* System */
+#define WDTCTL SIM_W(R_WDTCTL)
+#define WDTPW 0x5A00
+#define WDTHOLD 0x0080
+#define PM5CTL0 SIM_W(R_PM5CTL0)
+#define LOCKLPM5 0x0001
+#define SFRIE1 SIM_W(R_SFRIE1)
+#define SFRIFG1 SIM_W(R_SFRIFG1)
+#define SYSCFG0 SIM_W(R_SYSCFG0)
+#define FRWPPW 0xA500
+#define PFWP 0x0001
+#define DFWP 0x0002
+#define FRCTL0 SIM_W(R_FRCTL0)
+#define FRCTLPW 0xA500
+#define NWAITS_0 0x0000
+#define NWAITS_1 0x0010
+#define NWAITS_2 0x0020
+
+/* Clock system (storage only) */
+#define CSCTL0 SIM_W(R_CSCTL0)
+#define CSCTL0_H SIM_H(R_CSCTL0)
+#define CSCTL1 SIM_W(R_CSCTL1)
+#define CSCTL2 SIM_W(R_CSCTL2)
+#define CSCTL3 SIM_W(R_CSCTL3)
+#define CSCTL4 SIM_W(R_CSCTL4)
+#define CSCTL5 SIM_W(R_CSCTL5)
+#define CSCTL6 SIM_W(R_CSCTL6)
+#define CSCTL7 SIM_W(R_CSCTL7)
+#define CSCTL8 SIM_W(R_CSCTL8)
+#define CSKEY 0xA500
+#define DCORSEL 0x0040
+#define DCOFSEL_0 0x0000
+#define DCOFSEL_1 0x0002
+#define DCOFSEL_2 0x0004
+#define DCOFSEL_3 0x0006
+#define DCOFSEL_4 0x0008
+#define DCOFSEL_5 0x000A
+#define DCOFSEL_6 0x000C
+#define SELA__LFXTCLK 0x0000
+#define SELA__VLOCLK 0x0100
+#define SELA__REFOCLK 0x0100
+#define SELS__DCOCLK 0x0030
+#define SELS__MODOSC 0x0040
+#define SELM__DCOCLK 0x0003
+#define SELMS__DCOCLKDIV 0x0000
+#define SELREF__REFOCLK 0x0010
+#define DIVA__1 0x0000
+#define DIVS__1 0x0000
+#define DIVS__2 0x0010
+#define DIVS__4 0x0020
+#define DIVS__8 0x0030
+#define DIVM__1 0x0000
+#define SMCLKREQEN 0x0004
+#define MODCLKREQEN 0x0008
+#define DCORSEL_0 0x0000
+#define DCORSEL_1 0x0002
+#define DCORSEL_2 0x0004
+#define DCORSEL_3 0x0006
+#define DCORSEL_4 0x0008
+#define DCORSEL_5 0x000A
+#define FLLD_0 0x0000
+#define FLLD_1 0x1000
+#define FLLUNLOCK0 0x0100
+#define FLLUNLOCK1 0x0200
+
+/* Digital I/O */
+#define P1IN SIM_L(R_P1IN)
+#define P1OUT SIM_L(R_P1OUT)
+#define P1DIR SIM_L(R_P1DIR)
+#define P1REN SIM_L(R_P1REN)
+#define P1SEL0 SIM_L(R_P1SEL0)
+#define P1SEL1 SIM_L(R_P1SEL1)
+#define P1IES SIM_L(R_P1IES)
+#define P1IE SIM_L(R_P1IE)
+#define P1IFG SIM_L(R_P1IFG)
+#define P2IN SIM_L(R_P2IN)
+#define P2OUT SIM_L(R_P2OUT)
+#define P2DIR SIM_L(R_P2DIR)
+#define P2REN SIM_L(R_P2REN)
+#define P2SEL0 SIM_L(R_P2SEL0)
+#define P2SEL1 SIM_L(R_P2SEL1)
+#define P2IES SIM_L(R_P2IES)
+#define P2IE SIM_L(R_P2IE)
+#define P2IFG SIM_L(R_P2IFG)
+#define P3IN SIM_L(R_P3IN)
+#define P3OUT SIM_L(R_P3OUT)
+#define P3DIR SIM_L(R_P3DIR)
+#define P3REN SIM_L(R_P3REN)
+#define P3SEL0 SIM_L(R_P3SEL0)
+#define P3SEL1 SIM_L(R_P3SEL1)
+#define P4IN SIM_L(R_P4IN)
+#define P4OUT SIM_L(R_P4OUT)
+#define P4DIR SIM_L(R_P4DIR)
+#define P4REN SIM_L(R_P4REN)
+#define P4SEL0 SIM_L(R_P4SEL0)
+#define P4SEL1 SIM_L(R_P4SEL1)
+#define P4IES SIM_L(R_P4IES)
+#define P4IE SIM_L(R_P4IE)
+#define P4IFG SIM_L(R_P4IFG)
+#define P5IN SIM_L(R_P5IN)
+#define P5OUT SIM_L(R_P5OUT)
+#define P5DIR SIM_L(R_P5DIR)
+#define P5SEL0 SIM_L(R_P5SEL0)
+#define P5SEL1 SIM_L(R_P5SEL1)
+#define P6IN SIM_L(R_P6IN)
+#define P6OUT SIM_L(R_P6OUT)
+#define P6DIR SIM_L(R_P6DIR)
+#define P6SEL0 SIM_L(R_P6SEL0)
+#define P6SEL1 SIM_L(R_P6SEL1)
+
+/* Timer_A0, Timer_A1, Timer_B0. CCR0 compare and its interrupt are modelled; other channels are storage */
+#define TA0CTL SIM_W(R_TA0CTL)
+#define TA0CCTL0 SIM_W(R_TA0CCTL0)
+#define TA0CCTL1 SIM_W(R_TA0CCTL1)
+#define TA0CCTL2 SIM_W(R_TA0CCTL2)
+#define TA0CCR0 SIM_W(R_TA0CCR0)
+#define TA0CCR1 SIM_W(R_TA0CCR1)
+#define TA0CCR2 SIM_W(R_TA0CCR2)
+#define TA0R SIM_W(R_TA0R)
+#define TA0EX0 SIM_W(R_TA0EX0)
+#define TA0IV SIM_W(R_TA0IV)
+#define TA1CTL SIM_W(R_TA1CTL)
+#define TA1CCTL0 SIM_W(R_TA1CCTL0)
+#define TA1CCTL1 SIM_W(R_TA1CCTL1)
+#define TA1CCTL2 SIM_W(R_TA1CCTL2)
+#define TA1CCR0 SIM_W(R_TA1CCR0)
+#define TA1CCR1 SIM_W(R_TA1CCR1)
+#define TA1CCR2 SIM_W(R_TA1CCR2)
+#define TA1R SIM_W(R_TA1R)
+#define TA1EX0 SIM_W(R_TA1EX0)
+#define TA1IV SIM_W(R_TA1IV)
+#define TB0CTL SIM_W(R_TB0CTL)
+#define TB0CCTL0 SIM_W(R_TB0CCTL0)
+#define TB0CCTL1 SIM_W(R_TB0CCTL1)
+#define TB0CCTL2 SIM_W(R_TB0CCTL2)
+#define TB0CCR0 SIM_W(R_TB0CCR0)
+#define TB0CCR1 SIM_W(R_TB0CCR1)
+#define TB0CCR2 SIM_W(R_TB0CCR2)
+#define TB0R SIM_W(R_TB0R)
+#define TB0EX0 SIM_W(R_TB0EX0)
+#define TB0IV SIM_W(R_TB0IV)
+#define TASSEL_0 0x0000
+#define TASSEL_1 0x0100
+#define TASSEL_2 0x0200
+#define TASSEL__ACLK 0x0100
+#define TASSEL__SMCLK 0x0200
+#define TBSSEL_0 0x0000
+#define TBSSEL_1 0x0100
+#define TBSSEL_2 0x0200
+#define TBSSEL__ACLK 0x0100
+#define TBSSEL__SMCLK 0x0200
+#define ID_0 0x0000
+#define ID_1 0x0040
+#define ID_2 0x0080
+#define ID_3 0x00C0
+#define ID__1 0x0000
+#define ID__2 0x0040
+#define ID__4 0x0080
+#define ID__8 0x00C0
+#define MC_0 0x0000
+#define MC_1 0x0010
+#define MC_2 0x0020
+#define MC_3 0x0030
+#define MC__STOP 0x0000
+#define MC__UP 0x0010
+#define MC__CONTINUOUS 0x0020
+#define MC__CONTINOUS 0x0020
+#define MC__UPDOWN 0x0030
+#define TACLR 0x0004
+#define TAIE 0x0002
+#define TAIFG 0x0001
+#define TBCLR 0x0004
+#define TBIE 0x0002
+#define TBIFG 0x0001
+#define CCIE 0x0010
+#define CCIFG 0x0001
+#define TAIDEX_0 0
+#define TAIDEX_1 1
+#define TAIDEX_2 2
+#define TAIDEX_3 3
+#define TAIDEX_4 4
+#define TAIDEX_5 5
+#define TAIDEX_6 6
+#define TAIDEX_7 7
+#define TBIDEX_0 0
+#define TBIDEX_1 1
+#define TBIDEX_2 2
+#define TBIDEX_3 3
+#define TBIDEX_4 4
+#define TBIDEX_5 5
+#define TBIDEX_6 6
+#define TBIDEX_7 7
+#define TB0IV_NONE 0x00
+#define TB0IV_TBCCR1 0x02
+#define TB0IV_TBCCR2 0x04
+#define TB0IV_TBIFG 0x0E
+#define TA0IV_NONE 0x00
+#define TA0IV_TAIFG 0x0E
+
+/* eUSCI_B0 in I2C mode */
+#define UCB0CTLW0 SIM_W(R_UCB0CTLW0)
+#define UCB0CTL1 SIM_L(R_UCB0CTLW0)
+#define UCB0CTL0 SIM_H(R_UCB0CTLW0)
+#define UCB0CTLW1 SIM_W(R_UCB0CTLW1)
+#define UCB0BRW SIM_W(R_UCB0BRW)
+#define UCB0STATW SIM_W(R_UCB0STATW)
+#define UCB0TBCNT SIM_W(R_UCB0TBCNT)
+#define UCB0RXBUF SIM_W(R_UCB0RXBUF)
+#define UCB0TXBUF SIM_W(R_UCB0TXBUF)
+#define UCB0I2COA0 SIM_W(R_UCB0I2COA0)
+#define UCB0I2COA1 SIM_W(R_UCB0I2COA1)
+#define UCB0I2COA2 SIM_W(R_UCB0I2COA2)
+#define UCB0I2COA3 SIM_W(R_UCB0I2COA3)
+#define UCB0ADDRX SIM_W(R_UCB0ADDRX)
+#define UCB0ADDMASK SIM_W(R_UCB0ADDMASK)
+#define UCB0I2CSA SIM_W(R_UCB0I2CSA)
+#define UCB0IE SIM_W(R_UCB0IE)
+#define UCB0IFG SIM_W(R_UCB0IFG)
+#define UCB0IV SIM_W(R_UCB0IV)
+
+#define UCSWRST 0x0001
+#define UCTXSTT 0x0002
+#define UCTXSTP 0x0004
+#define UCTXNACK 0x0008
+#define UCTR 0x0010
+#define UCTXACK 0x0020
+#define UCSSEL_1 0x0040
+#define UCSSEL_2 0x0080
+#define UCSSEL__ACLK 0x0040
+#define UCSSEL__SMCLK 0x0080
+#define UCSYNC 0x0100
+#define UCMODE_3 0x0600
+#define UCMST 0x0800
+#define UCMM 0x2000
+#define UCSLA10 0x4000
+#define UCA10 0x8000
+#define UCASTP_0 0x0000
+#define UCASTP_1 0x0004
+#define UCASTP_2 0x0008
+#define UCASTP_3 0x000C
+#define UCSWACK 0x0010
+#define UCSTPNACK 0x0020
+#define UCCLTO_0 0x0000
+#define UCCLTO_1 0x0040
+#define UCCLTO_2 0x0080
+#define UCCLTO_3 0x00C0
+#define UCBBUSY 0x0010
+#define UCGC 0x0020
+#define UCSCLLOW 0x0040
+#define UCTBCNT0 0x0001
+#define UCOAEN 0x0400
+#define UCGCEN 0x8000
+
+#define UCRXIFG0 0x0001
+#define UCTXIFG0 0x0002
+#define UCSTTIFG 0x0004
+#define UCSTPIFG 0x0008
+#define UCALIFG 0x0010
+#define UCNACKIFG 0x0020
+#define UCBCNTIFG 0x0040
+#define UCCLTOIFG 0x0080
+#define UCRXIFG1 0x0100
+#define UCTXIFG1 0x0200
+#define UCRXIFG2 0x0400
+#define UCTXIFG2 0x0800
+#define UCRXIFG3 0x1000
+#define UCTXIFG3 0x2000
+#define UCBIT9IFG 0x4000
+#define UCRXIE0 0x0001
+#define UCTXIE0 0x0002
+#define UCSTTIE 0x0004
+#define UCSTPIE 0x0008
+#define UCALIE 0x0010
+#define UCNACKIE 0x0020
+#define UCBCNTIE 0x0040
+#define UCCLTOIE 0x0080
+#define UCRXIE1 0x0100
+#define UCTXIE1 0x0200
+#define UCRXIE2 0x0400
+#define UCTXIE2 0x0800
+#define UCRXIE3 0x1000
+#define UCTXIE3 0x2000
+#define UCBIT9IE 0x4000
+
+#define USCI_NONE 0x00
+#define USCI_I2C_UCALIFG 0x02
+#define USCI_I2C_UCNACKIFG 0x04
+#define USCI_I2C_UCSTTIFG 0x06
+#define USCI_I2C_UCSTPIFG 0x08
+#define USCI_I2C_UCRXIFG3 0x0A
+#define USCI_I2C_UCTXIFG3 0x0C
+#define USCI_I2C_UCRXIFG2 0x0E
+#define USCI_I2C_UCTXIFG2 0x10
+#define USCI_I2C_UCRXIFG1 0x12
+#define USCI_I2C_UCTXIFG1 0x14
+#define USCI_I2C_UCRXIFG0 0x16
+#define USCI_I2C_UCTXIFG0 0x18
+#define USCI_I2C_UCBCNTIFG 0x1A
+#define USCI_I2C_UCCLTOIFG 0x1C
+#define USCI_I2C_UCBIT9IFG 0x1E
+
+#endif
@@ -0,0 +1,993 @@
+/* Simulator engine behind host/msp430.h and host/sim.h. Registers are plain storage; every firmware access goes
+   through sim_reg(), which first applies what the firmware wrote since the last access (eUSCI control bits, TXBUF,
+   timer setup, port outputs), then charges SimAccessCycles of MCLK, runs the bus and timer events that fall in that
+   time and takes pending interrupts. Low power modes run events until an ISR clears the LPM bits on exit.
+   Modelled: eUSCI_B0 I2C master and slave (7-bit addresses, OA0-3, ADDMASK, general call, UCASTP_2 automatic STOP,
+   stretching while TXBUF is empty or RXBUF full), CCR0 compare of TA0/TA1/TB0 in up and continuous mode, 6 cycles
+   of interrupt entry and 5 of RETI. Not modelled: 10-bit addressing, arbitration, clock low timeout, other timer
+   channels, port interrupts and clock system changes.
+*/
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msp430.h"
+#include "sim.h"
+#undef main
+
+extern void fw_main(void); //Firmware main, renamed with -Dmain=fw_main
+
+double SimMclk = 1e6;
+double SimAclk = 1e4;
+uint64_t SimEnd = 3000000000ULL;
+unsigned SimAccessCycles = 4;
+uint64_t SimNow;
+void (*SimWatch)(void);
+void (*SimAtEnd)(void);
+
+static uint16_t Reg[R_COUNT];
+static uint16_t Sr, IsrSr;
+static int InIsr;
+static const sim_peer_t *Peer;
+
+/* Open-drain bus */
+static int DrvScl[2], DrvSda[2];
+static int Scl = 1, Sda = 1, Settling;
+
+/* eUSCI_B0 */
+static struct i2c_master FwM;
+static struct i2c_slave FwS;
+static int Role, RxFull, RxRead, TxFull, SlaveIdx, Warned10;
+static uint8_t TxByte;
+static uint16_t CtlShadow;
+
+/* Timers, CCR0 only */
+struct timer {
+    int base; //R_TA0CTL, R_TA1CTL or R_TB0CTL; the other registers follow in the order of TIMER_REGS
+    uint16_t ctl, ccr0, ex0; //Configuration the counter was last based on
+    uint64_t base_time, fire_k; //fire_k: tick index of the next CCR0 compare, SIM_NEVER if stopped
+    uint32_t base_cnt;
+    double tick; //ns per count
+};
+enum { T_CTL, T_CCTL0, T_CCTL1, T_CCTL2, T_CCR0, T_CCR1, T_CCR2, T_R, T_EX0, T_IV };
+static struct timer Timer[3] = { { .base = R_TA0CTL }, { .base = R_TA1CTL }, { .base = R_TB0CTL } };
+
+/* Interrupt vectors, highest priority first. The ISR is found by name in the firmware (link with -rdynamic) */
+static struct {
+    const char *vector;
+    const char *names[3];
+    int timer; //Index into Timer[] for CCR0 vectors, -1 for eUSCI_B0
+    void (*fn)(void);
+} Vec[] = {
+    { "TIMER0_B0", { "Timer_B", "TIMER_B0" }, 2, NULL },
+    { "USCI_B0", { "USCI_B0_ISR", "USCIB0_ISR" }, -1, NULL },
+    { "TIMER0_A0", { "TIMER_A0", "timerfoo" }, 0, NULL },
+    { "TIMER1_A0", { "TIMER_A1", "TIMER1_A0" }, 1, NULL },
+};
+#define NVEC (sizeof Vec / sizeof Vec[0])
+static const char *VecOverride[NVEC];
+
+/* VCD trace */
+#define MAXVAR 32
+static FILE *Vcd;
+static uint64_t VcdTime = SIM_NEVER;
+static int NVar, Started;
+static struct { char name[24]; int width; uint32_t value; } Var[MAXVAR];
+static int VScl, VSda, VDrv[2][2], VCpu, VIsr, VPort[6];
+static uint16_t PortShadow[6];
+static const int PortReg[6] = { R_P1OUT, R_P2OUT, R_P3OUT, R_P4OUT, R_P5OUT, R_P6OUT };
+
+static void run_due(uint64_t t);
+
+/* ---- VCD ---- */
+
+int sim_vcd_open(const char *path)
+{
+    Vcd = fopen(path, "w");
+    return Vcd ? 0 : -1;
+}
+
+int sim_vcd_var(const char *name, int width)
+{
+    if (NVar == MAXVAR || Started) return -1;
+    snprintf(Var[NVar].name, sizeof Var[NVar].name, "%s", name);
+    Var[NVar].width = width;
+    return NVar++;
+}
+
+static void vcd_value(int v)
+{
+    int b;
+    if (Var[v].width == 1) fprintf(Vcd, "%u%c\n", Var[v].value & 1, '!' + v);
+    else
+    {
+        fputc('b', Vcd);
+        for (b = Var[v].width - 1; b >= 0; b--) fputc('0' + ((Var[v].value >> b) & 1), Vcd);
+        fprintf(Vcd, " %c\n", '!' + v);
+    }
+}
+
+void sim_vcd_set(int var, uint32_t value)
+{
+    if (var < 0 || Var[var].value == value) return;
+    Var[var].value = value;
+    if (!Vcd || !Started) return;
+    if (VcdTime != SimNow)
+    {
+        fprintf(Vcd, "#%llu\n", (unsigned long long)SimNow);
+        VcdTime = SimNow;
+    }
+    vcd_value(var);
+}
+
+static void vcd_header(void)
+{
+    int v;
+    if (!Vcd) return;
+    fprintf(Vcd, "$timescale 1ns $end\n$scope module i2c $end\n");
+    for (v = 0; v < NVar; v++) fprintf(Vcd, "$var wire %d %c %s $end\n", Var[v].width, '!' + v, Var[v].name);
+    fprintf(Vcd, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+    for (v = 0; v < NVar; v++) vcd_value(v);
+    fprintf(Vcd, "$end\n");
+    VcdTime = 0;
+}
+
+static void vcd_cpu(void)
+{
+    sim_vcd_set(VCpu, InIsr || !(Sr & CPUOFF));
+    sim_vcd_set(VIsr, InIsr);
+}
+
+/* ---- Bus ---- */
+
+int sim_scl(void) { return Scl; }
+int sim_sda(void) { return Sda; }
+int sim_driving_scl(int dev) { return DrvScl[dev]; }
+int sim_fw_role(void) { return Role; }
+int sim_cpu_active(void) { return InIsr || !(Sr & CPUOFF); }
+int sim_in_isr(void) { return InIsr; }
+int sim_fw_stalled(void) { return Role == 1 ? FwM.stalled : Role == 2 ? FwS.stalled == 1 : 0; }
+
+static void notify_edge(int scl, int sda, int old_scl, int old_sda)
+{
+    if (Role == 1) i2c_master_edge(&FwM);
+    else if (Role == 2) i2c_slave_edge(&FwS, scl, sda, old_scl, old_sda);
+    if (Peer && Peer->edge) Peer->edge(scl, sda, old_scl, old_sda);
+}
+
+void sim_drive(int dev, int scl_low, int sda_low)
+{
+    int scl, sda, old;
+    DrvScl[dev] = scl_low;
+    DrvSda[dev] = sda_low;
+    sim_vcd_set(VDrv[dev][0], scl_low);
+    sim_vcd_set(VDrv[dev][1], sda_low);
+    if (Settling) return; //The outer call picks up the new levels
+    Settling = 1;
+    for (;;)
+    {
+        scl = !(DrvScl[0] || DrvScl[1]);
+        sda = !(DrvSda[0] || DrvSda[1]);
+        if (scl != Scl && (!scl || sda == Sda)) //SDA moves first when SCL is released with it
+        {
+            old = Scl;
+            Scl = scl;
+            sim_vcd_set(VScl, Scl);
+            notify_edge(Scl, Sda, old, Sda);
+        }
+        else if (sda != Sda)
+        {
+            old = Sda;
+            Sda = sda;
+            sim_vcd_set(VSda, Sda);
+            notify_edge(Scl, Sda, Scl, old);
+        }
+        else break;
+    }
+    Settling = 0;
+    if (SimWatch) SimWatch();
+}
+
+/* ---- I2C master ---- */
+
+enum { M_IDLE, M_START, M_LOW, M_REL, M_WAITHIGH, M_HIGH, M_HOLDTX, M_HOLDRX, M_HOLDNACK,
+       M_STOP1, M_STOP2, M_STOPWAIT, M_STOP3, M_RS1, M_RS2, M_RSWAIT, M_RS3, M_BUF };
+enum { K_ADDR, K_TX, K_RX };
+
+static void m_drive(struct i2c_master *m, int scl_low, int sda_low) { sim_drive(m->dev, scl_low, sda_low); }
+
+static void m_stalled(struct i2c_master *m, int stalled)
+{
+    if (m->stalled == stalled) return;
+    m->stalled = stalled;
+    if (SimWatch) SimWatch();
+}
+
+static void m_byte(struct i2c_master *m, int kind, uint8_t b)
+{
+    m->kind = kind;
+    m->shift = b;
+    m->bit = 0;
+    m_stalled(m, 0);
+    m->state = M_LOW;
+    m->wake = SimNow + m->half / 2;
+}
+
+static void m_stall(struct i2c_master *m, int state)
+{
+    m->state = state;
+    m->wake = SIM_NEVER;
+    m_stalled(m, 1);
+}
+
+static void m_stop(struct i2c_master *m)
+{
+    m_stalled(m, 0);
+    m->state = M_STOP1;
+    m->wake = SimNow + m->half / 2;
+}
+
+static void m_restart(struct i2c_master *m)
+{
+    m_stalled(m, 0);
+    m->state = M_RS1;
+    m->wake = SimNow + m->half / 2;
+}
+
+static int m_counted(struct i2c_master *m)
+{
+    unsigned n = m->count ? m->count(m) : 0;
+    return n && (unsigned)m->bytes >= n;
+}
+
+static void m_next_tx(struct i2c_master *m)
+{
+    uint8_t b;
+    if (m_counted(m)) m_stop(m);
+    else if (m->tx(m, &b)) m_byte(m, K_TX, b);
+    else if (m->want_stop(m)) m_stop(m);
+    else if (m->want_start(m)) m_restart(m);
+    else m_stall(m, M_HOLDTX); //SCL held low until TXBUF is written
+}
+
+static void m_after_nack(struct i2c_master *m)
+{
+    if (m->want_stop(m) || m_counted(m)) m_stop(m);
+    else if (m->want_start(m)) m_restart(m);
+    else if (m->kind == K_RX) m_stop(m);
+    else m_stall(m, M_HOLDNACK);
+}
+
+//SCL is low: put the next bit on SDA
+static void m_setbit(struct i2c_master *m)
+{
+    int sda_low = 0;
+    unsigned n;
+    if (m->bit < 8)
+    {
+        if (m->kind != K_RX) sda_low = !((m->shift >> (7 - m->bit)) & 1);
+    }
+    else if (m->kind == K_RX)
+    {
+        if (!m->rx_free(m))
+        {
+            m_stall(m, M_HOLDRX); //SCL held low until RXBUF is read
+            return;
+        }
+        m_stalled(m, 0);
+        m->rx(m, m->shift);
+        n = m->count ? m->count(m) : 0;
+        m->nack_sent = m->want_stop(m) || m->want_start(m) || (n && (unsigned)m->bytes + 1 >= n);
+        sda_low = !m->nack_sent;
+    }
+    m_drive(m, 1, sda_low);
+    m->state = M_REL;
+    m->wake = SimNow + m->half - m->half / 2;
+}
+
+//End of SCL high: sample SDA and pull SCL low
+static void m_sample(struct i2c_master *m)
+{
+    if (m->bit < 8)
+    {
+        if (m->kind == K_RX) m->shift = (m->shift << 1) | Sda;
+    }
+    else if (m->kind != K_RX) m->ack = !Sda;
+    m_drive(m, 1, DrvSda[m->dev]);
+    if (++m->bit < 9)
+    {
+        m->state = M_LOW;
+        m->wake = SimNow + m->half / 2;
+        return;
+    }
+    if (m->kind == K_ADDR)
+    {
+        if (!m->ack)
+        {
+            m->event(m, M_EV_NACK);
+            m_after_nack(m);
+            return;
+        }
+        m->event(m, M_EV_ADDR_ACK);
+        if (m->addr & 1) m_byte(m, K_RX, 0);
+        else m_next_tx(m);
+        return;
+    }
+    m->bytes++;
+    m->event(m, M_EV_BYTE);
+    if (m->kind == K_TX)
+    {
+        if (!m->ack)
+        {
+            m->event(m, M_EV_NACK);
+            m_after_nack(m);
+        }
+        else m_next_tx(m);
+    }
+    else if (m->nack_sent) m_after_nack(m);
+    else m_byte(m, K_RX, 0);
+}
+
+static void m_begin(struct i2c_master *m)
+{
+    m->bytes = 0;
+    m->addr = m->address(m);
+    m->event(m, M_EV_START);
+    m->state = M_START;
+    m->wake = SimNow + m->half;
+}
+
+void i2c_master_reset(struct i2c_master *m)
+{
+    m->state = M_IDLE;
+    m->wake = SIM_NEVER;
+    m->stalled = 0;
+    m_drive(m, 0, 0);
+}
+
+void i2c_master_step(struct i2c_master *m)
+{
+    int timed = m->wake != SIM_NEVER;
+    if (timed && SimNow < m->wake) return;
+    switch (m->state)
+    {
+    case M_IDLE:
+        m->wake = SIM_NEVER;
+        if (m->want_start(m) && Scl && Sda)
+        {
+            m_drive(m, 0, 1); //START
+            m_begin(m);
+        }
+        break;
+    case M_START: m_drive(m, 1, 1); m_byte(m, K_ADDR, m->addr); break;
+    case M_LOW: case M_HOLDRX: m_setbit(m); break;
+    case M_REL:
+        m_drive(m, 0, DrvSda[m->dev]);
+        if (Scl) { m->state = M_HIGH; m->wake = SimNow + m->half; }
+        else { m->state = M_WAITHIGH; m->wake = SIM_NEVER; } //Slave stretching
+        break;
+    case M_HIGH: m_sample(m); break;
+    case M_HOLDTX: m_next_tx(m); break;
+    case M_HOLDNACK: m_after_nack(m); break;
+    case M_STOP1: m_drive(m, 1, 1); m->state = M_STOP2; m->wake = SimNow + m->half - m->half / 2; break;
+    case M_STOP2:
+        m_drive(m, 0, 1);
+        if (Scl) { m->state = M_STOP3; m->wake = SimNow + m->half; }
+        else { m->state = M_STOPWAIT; m->wake = SIM_NEVER; }
+        break;
+    case M_STOP3:
+        m_drive(m, 0, 0); //STOP
+        m->event(m, M_EV_STOP);
+        m->state = M_BUF;
+        m->wake = SimNow + m->half;
+        break;
+    case M_BUF: m->state = M_IDLE; m->wake = SIM_NEVER; i2c_master_step(m); break;
+    case M_RS1: m_drive(m, 1, 0); m->state = M_RS2; m->wake = SimNow + m->half - m->half / 2; break;
+    case M_RS2:
+        m_drive(m, 0, 0);
+        if (Scl) { m->state = M_RS3; m->wake = SimNow + m->half; }
+        else { m->state = M_RSWAIT; m->wake = SIM_NEVER; }
+        break;
+    case M_RS3: m_drive(m, 0, 1); m_begin(m); break; //Repeated START
+    default: break;
+    }
+}
+
+void i2c_master_edge(struct i2c_master *m)
+{
+    if (!Scl) return;
+    if (m->state == M_WAITHIGH) { m->state = M_HIGH; m->wake = SimNow + m->half; }
+    else if (m->state == M_STOPWAIT) { m->state = M_STOP3; m->wake = SimNow + m->half; }
+    else if (m->state == M_RSWAIT) { m->state = M_RS3; m->wake = SimNow + m->half; }
+    else if (m->state == M_IDLE && Sda) i2c_master_step(m);
+}
+
+/* ---- I2C slave ---- */
+
+enum { S_IDLE, S_ADDR, S_RX, S_TX, S_DONE, S_IGNORE };
+
+//Drive SDA and either release SCL or stretch it for the hold a hook asked for
+static void s_finish(struct i2c_slave *s, int sda_low)
+{
+    s->stalled = 0;
+    if (DrvScl[s->dev]) sim_drive(s->dev, 1, sda_low); //Set up SDA before a stretch ends
+    if (s->hold)
+    {
+        sim_drive(s->dev, 1, sda_low);
+        s->wake = SimNow + s->hold;
+        s->hold = 0;
+        s->stalled = 2;
+    }
+    else sim_drive(s->dev, 0, sda_low);
+}
+
+static void s_ack(struct i2c_slave *s)
+{
+    int r = s->rx(s, s->shift);
+    if (r < 0)
+    {
+        sim_drive(s->dev, 1, 0); //RXBUF full: hold SCL low
+        s->stalled = 1;
+        return;
+    }
+    s_finish(s, r > 0);
+}
+
+static void s_load(struct i2c_slave *s)
+{
+    uint8_t b;
+    if (!s->tx(s, &b))
+    {
+        sim_drive(s->dev, 1, 0); //TXBUF empty: hold SCL low
+        s->stalled = 1;
+        return;
+    }
+    s->txbyte = b;
+    s_finish(s, !(b & 0x80));
+}
+
+void i2c_slave_reset(struct i2c_slave *s)
+{
+    s->state = S_IDLE;
+    s->stalled = 0;
+    s->hold = 0;
+    s->wake = SIM_NEVER;
+    sim_drive(s->dev, 0, 0);
+}
+
+void i2c_slave_step(struct i2c_slave *s)
+{
+    if (s->stalled == 2)
+    {
+        if (SimNow < s->wake) return;
+        s->wake = SIM_NEVER;
+        s->stalled = 0;
+        sim_drive(s->dev, 0, DrvSda[s->dev]);
+    }
+    else if (s->stalled == 1)
+    {
+        if (s->state == S_RX) s_ack(s);
+        else if (s->state == S_TX) s_load(s);
+    }
+}
+
+void i2c_slave_edge(struct i2c_slave *s, int scl, int sda, int old_scl, int old_sda)
+{
+    int addressed = s->state == S_RX || s->state == S_TX || s->state == S_DONE;
+    if (scl && old_scl && !sda && old_sda) //START or repeated START
+    {
+        if (addressed) s->event(s, S_EV_RESTART);
+        s->state = S_ADDR;
+        s->rises = 0;
+        s->shift = 0;
+        s->stalled = 0;
+        s->wake = SIM_NEVER;
+        sim_drive(s->dev, 0, 0);
+        return;
+    }
+    if (scl && old_scl && sda && !old_sda) //STOP
+    {
+        if (addressed) s->event(s, S_EV_STOP);
+        i2c_slave_reset(s);
+        return;
+    }
+    if (scl && !old_scl)
+    {
+        if (s->state == S_ADDR || s->state == S_RX)
+        {
+            if (s->rises < 8) s->shift = (s->shift << 1) | sda;
+            s->rises++;
+        }
+        else if (s->state == S_TX && ++s->rises == 9) s->master_ack = !sda;
+        return;
+    }
+    if (scl || !old_scl) return;
+    switch (s->state) //SCL fell
+    {
+    case S_ADDR:
+        if (s->rises == 8)
+        {
+            if (!s->match(s, s->shift))
+            {
+                s->state = S_IGNORE;
+                return;
+            }
+            s->rw = s->shift & 1;
+            s_finish(s, 1);
+        }
+        else if (s->rises == 9)
+        {
+            s->rises = 0;
+            s->shift = 0;
+            if (s->rw) { s->state = S_TX; s_load(s); }
+            else { s->state = S_RX; sim_drive(s->dev, 0, 0); }
+        }
+        break;
+    case S_RX:
+        if (s->rises == 8) s_ack(s);
+        else if (s->rises == 9)
+        {
+            s->rises = 0;
+            s->shift = 0;
+            sim_drive(s->dev, 0, 0);
+        }
+        break;
+    case S_TX:
+        if (s->rises < 8) sim_drive(s->dev, 0, !((s->txbyte >> (7 - s->rises)) & 1));
+        else if (s->rises == 8) sim_drive(s->dev, 0, 0);
+        else
+        {
+            s->rises = 0;
+            if (s->master_ack) s_load(s);
+            else s->state = S_DONE; //Master NACK ends the read
+        }
+        break;
+    default: break;
+    }
+}
+
+/* ---- eUSCI_B0 ---- */
+
+static void ctl_set(uint16_t bits) { Reg[R_UCB0CTLW0] |= bits; CtlShadow |= bits; }
+static void ctl_clear(uint16_t bits) { Reg[R_UCB0CTLW0] &= ~bits; CtlShadow &= ~bits; }
+static uint16_t rx_flag(int idx) { return idx ? 0x0100 << (2 * (idx - 1)) : UCRXIFG0; }
+
+static int fm_want_start(struct i2c_master *m) { (void)m; return Reg[R_UCB0CTLW0] & UCTXSTT; }
+static int fm_want_stop(struct i2c_master *m) { (void)m; return Reg[R_UCB0CTLW0] & UCTXSTP; }
+static int fm_rx_free(struct i2c_master *m) { (void)m; return !RxFull; }
+
+static uint8_t fm_address(struct i2c_master *m)
+{
+    (void)m;
+    if ((Reg[R_UCB0CTLW0] & UCSLA10) && !Warned10++)
+        fprintf(stderr, "sim: 10-bit addressing is not modelled, sending the low 7 bits\n");
+    return ((Reg[R_UCB0I2CSA] & 0x7F) << 1) | ((Reg[R_UCB0CTLW0] & UCTR) ? 0 : 1);
+}
+
+static int fm_tx(struct i2c_master *m, uint8_t *b)
+{
+    (void)m;
+    if (!TxFull) return 0;
+    *b = TxByte;
+    TxFull = 0;
+    Reg[R_UCB0IFG] |= UCTXIFG0;
+    return 1;
+}
+
+static void fm_rx(struct i2c_master *m, uint8_t b)
+{
+    (void)m;
+    Reg[R_UCB0RXBUF] = b;
+    RxFull = 1;
+    Reg[R_UCB0IFG] |= UCRXIFG0;
+}
+
+static unsigned fm_count(struct i2c_master *m)
+{
+    (void)m;
+    return (Reg[R_UCB0CTLW1] & UCASTP_3) == UCASTP_2 ? Reg[R_UCB0TBCNT] : 0;
+}
+
+static void fm_event(struct i2c_master *m, int ev)
+{
+    double clk = (Reg[R_UCB0CTLW0] & 0xC0) == UCSSEL__ACLK ? SimAclk : SimMclk;
+    uint16_t brw = Reg[R_UCB0BRW] ? Reg[R_UCB0BRW] : 1;
+    switch (ev)
+    {
+    case M_EV_START:
+        m->half = (uint64_t)(brw * 1e9 / clk / 2);
+        Reg[R_UCB0STATW] |= UCBBUSY;
+        if ((Reg[R_UCB0CTLW0] & UCTR) && !TxFull) Reg[R_UCB0IFG] |= UCTXIFG0;
+        break;
+    case M_EV_ADDR_ACK: ctl_clear(UCTXSTT); break;
+    case M_EV_NACK: //A byte already in TXBUF is discarded, as on the eUSCI
+        ctl_clear(UCTXSTT);
+        TxFull = 0;
+        Reg[R_UCB0IFG] |= UCNACKIFG;
+        break;
+    case M_EV_BYTE: if (m->bytes == Reg[R_UCB0TBCNT]) Reg[R_UCB0IFG] |= UCBCNTIFG; break;
+    case M_EV_STOP:
+        ctl_clear(UCTXSTP);
+        Reg[R_UCB0IFG] |= UCSTPIFG;
+        Reg[R_UCB0STATW] &= ~UCBBUSY;
+        break;
+    }
+}
+
+static int fs_match(struct i2c_slave *s, uint8_t a)
+{
+    uint16_t a7 = a >> 1, oa;
+    int i, idx = -1;
+    (void)s;
+    oa = Reg[R_UCB0I2COA0];
+    if ((oa & UCOAEN) && !((a7 ^ oa) & Reg[R_UCB0ADDMASK] & 0x7F)) idx = 0;
+    for (i = 1; i < 4 && idx < 0; i++)
+    {
+        oa = Reg[R_UCB0I2COA0 + i];
+        if ((oa & UCOAEN) && (oa & 0x7F) == a7) idx = i;
+    }
+    if (idx < 0 && a7 == 0 && !(a & 1) && (Reg[R_UCB0I2COA0] & UCGCEN))
+    {
+        idx = 0;
+        Reg[R_UCB0STATW] |= UCGC;
+    }
+    if (idx < 0) return 0;
+    SlaveIdx = idx;
+    TxFull = 0; //A byte left over from the last read is not sent
+    Reg[R_UCB0ADDRX] = a7;
+    Reg[R_UCB0STATW] |= UCBBUSY;
+    if (a & 1) ctl_set(UCTR);
+    else ctl_clear(UCTR);
+    Reg[R_UCB0IFG] |= UCSTTIFG | ((a & 1) ? rx_flag(idx) << 1 : 0);
+    return 1;
+}
+
+static int fs_rx(struct i2c_slave *s, uint8_t b)
+{
+    int nack;
+    (void)s;
+    if (RxFull) return -1;
+    Reg[R_UCB0RXBUF] = b;
+    RxFull = 1;
+    Reg[R_UCB0IFG] |= rx_flag(SlaveIdx);
+    nack = Reg[R_UCB0CTLW0] & UCTXNACK;
+    ctl_clear(UCTXNACK);
+    return !nack;
+}
+
+static int fs_tx(struct i2c_slave *s, uint8_t *b)
+{
+    (void)s;
+    if (!TxFull) return 0;
+    *b = TxByte;
+    TxFull = 0;
+    Reg[R_UCB0IFG] |= rx_flag(SlaveIdx) << 1;
+    return 1;
+}
+
+static void fs_event(struct i2c_slave *s, int ev)
+{
+    (void)s;
+    if (ev != S_EV_STOP) return;
+    Reg[R_UCB0IFG] |= UCSTPIFG;
+    Reg[R_UCB0STATW] &= ~(UCBBUSY | UCGC);
+}
+
+static void usci_sync(void)
+{
+    uint16_t ctl = Reg[R_UCB0CTLW0];
+    if ((ctl ^ CtlShadow) & UCSWRST)
+    {
+        RxFull = TxFull = RxRead = 0;
+        Reg[R_UCB0IE] = Reg[R_UCB0IFG] = Reg[R_UCB0STATW] = 0;
+        if (Role == 1) i2c_master_reset(&FwM);
+        if (Role == 2) i2c_slave_reset(&FwS);
+        Role = (ctl & UCSWRST) ? 0 : (ctl & UCMST) ? 1 : 2;
+        if (Role == 1) i2c_master_reset(&FwM);
+        if (Role == 2) i2c_slave_reset(&FwS);
+    }
+    CtlShadow = ctl;
+    if (Reg[R_UCB0TXBUF] != 0xFFFF) //Written since the last access
+    {
+        if (Role)
+        {
+            TxByte = Reg[R_UCB0TXBUF];
+            TxFull = 1;
+            Reg[R_UCB0IFG] &= ~(UCTXIFG0 | UCTXIFG1 | UCTXIFG2 | UCTXIFG3);
+        }
+        Reg[R_UCB0TXBUF] = 0xFFFF;
+    }
+    if (RxRead)
+    {
+        RxFull = 0;
+        RxRead = 0;
+    }
+    if (Role == 1) i2c_master_step(&FwM);
+    else if (Role == 2) i2c_slave_step(&FwS);
+}
+
+static uint16_t usci_iv(void)
+{
+    static const uint16_t flag[] = { UCALIFG, UCNACKIFG, UCSTTIFG, UCSTPIFG, UCRXIFG3, UCTXIFG3, UCRXIFG2,
+        UCTXIFG2, UCRXIFG1, UCTXIFG1, UCRXIFG0, UCTXIFG0, UCBCNTIFG, UCCLTOIFG, UCBIT9IFG };
+    uint16_t pending = Reg[R_UCB0IFG] & Reg[R_UCB0IE];
+    unsigned i;
+    for (i = 0; i < sizeof flag / sizeof flag[0]; i++)
+        if (pending & flag[i])
+        {
+            Reg[R_UCB0IFG] &= ~flag[i];
+            return 2 * (i + 1);
+        }
+    return 0;
+}
+
+/* ---- Timers ---- */
+
+static int t_running(struct timer *t)
+{
+    int mc = (t->ctl >> 4) & 3;
+    return t->tick > 0 && mc && !(mc != 2 && t->ccr0 == 0);
+}
+
+static uint32_t t_count(struct timer *t, uint64_t when)
+{
+    uint64_t n, d;
+    uint32_t p = t->ccr0 + 1;
+    if (!t_running(t)) return t->base_cnt;
+    n = (uint64_t)((when - t->base_time) / t->tick);
+    if (((t->ctl >> 4) & 3) == 2) return (t->base_cnt + n) & 0xFFFF;
+    if (t->base_cnt <= t->ccr0) return (t->base_cnt + n) % p;
+    d = 0x10000 - t->base_cnt; //CCR0 was moved below the count: run up to 0xFFFF first
+    return n < d ? t->base_cnt + n : (n - d) % p;
+}
+
+static void t_sync(struct timer *t)
+{
+    uint16_t ctl = Reg[t->base + T_CTL], ccr0 = Reg[t->base + T_CCR0], ex0 = Reg[t->base + T_EX0];
+    double clk;
+    uint32_t cnt, d;
+    if (ctl == t->ctl && ccr0 == t->ccr0 && ex0 == t->ex0) return;
+    cnt = t_count(t, SimNow);
+    if (ctl & TACLR)
+    {
+        cnt = 0;
+        ctl &= ~TACLR;
+        Reg[t->base + T_CTL] = ctl;
+    }
+    t->ctl = ctl;
+    t->ccr0 = ccr0;
+    t->ex0 = ex0;
+    t->base_time = SimNow;
+    t->base_cnt = cnt;
+    clk = (ctl & 0x300) == TASSEL_1 ? SimAclk : (ctl & 0x300) == TASSEL_2 ? SimMclk : 0;
+    t->tick = clk ? 1e9 * (1 << ((ctl >> 6) & 3)) * ((ex0 & 7) + 1) / clk : 0;
+    t->fire_k = SIM_NEVER;
+    if (!t_running(t)) return;
+    if (((ctl >> 4) & 3) == 2) d = (uint16_t)(ccr0 - cnt);
+    else if (cnt <= ccr0) d = ccr0 - cnt;
+    else d = 0x10000 - cnt + ccr0;
+    t->fire_k = d ? d : ((((ctl >> 4) & 3) == 2) ? 0x10000 : ccr0 + 1u);
+}
+
+static uint64_t t_next(struct timer *t)
+{
+    return t->fire_k == SIM_NEVER ? SIM_NEVER : t->base_time + (uint64_t)(t->fire_k * t->tick + 0.999);
+}
+
+static void t_fire(struct timer *t)
+{
+    Reg[t->base + T_CCTL0] |= CCIFG;
+    t->fire_k += ((t->ctl >> 4) & 3) == 2 ? 0x10000 : t->ccr0 + 1u;
+}
+
+/* ---- Core ---- */
+
+static void sync(void)
+{
+    int i;
+    usci_sync();
+    for (i = 0; i < 3; i++) t_sync(&Timer[i]);
+    for (i = 0; i < 6; i++)
+        if ((Reg[PortReg[i]] & 0xFF) != PortShadow[i])
+        {
+            PortShadow[i] = Reg[PortReg[i]] & 0xFF;
+            sim_vcd_set(VPort[i], PortShadow[i]);
+        }
+}
+
+static int pending_vector(void)
+{
+    unsigned v;
+    for (v = 0; v < NVEC; v++)
+    {
+        if (!Vec[v].fn) continue;
+        if (Vec[v].timer < 0)
+        {
+            if (Role && (Reg[R_UCB0IFG] & Reg[R_UCB0IE])) return v;
+        }
+        else if ((Reg[Timer[Vec[v].timer].base + T_CCTL0] & (CCIE | CCIFG)) == (CCIE | CCIFG)) return v;
+    }
+    return -1;
+}
+
+static void cycles(uint64_t n)
+{
+    run_due(SimNow + (uint64_t)(n * 1e9 / SimMclk + 0.5));
+}
+
+static void take_interrupts(void)
+{
+    int v;
+    while (!InIsr && (Sr & GIE) && (v = pending_vector()) >= 0)
+    {
+        IsrSr = Sr;
+        Sr = 0;
+        InIsr = 1;
+        vcd_cpu();
+        cycles(6);
+        if (Vec[v].timer >= 0) Reg[Timer[Vec[v].timer].base + T_CCTL0] &= ~CCIFG;
+        Vec[v].fn();
+        sync();
+        cycles(5);
+        Sr = IsrSr;
+        InIsr = 0;
+        vcd_cpu();
+    }
+}
+
+static uint64_t next_event(int *src)
+{
+    uint64_t t, best = SIM_NEVER;
+    int i;
+    *src = -1;
+    t = Role == 1 ? FwM.wake : Role == 2 ? FwS.wake : SIM_NEVER;
+    if (t < best) { best = t; *src = 0; }
+    if (Peer && (t = Peer->next()) < best) { best = t; *src = 1; }
+    for (i = 0; i < 3; i++)
+        if ((t = t_next(&Timer[i])) < best) { best = t; *src = 2 + i; }
+    return best;
+}
+
+static void run_due(uint64_t until)
+{
+    int src;
+    uint64_t t;
+    if (until > SimEnd) until = SimEnd;
+    for (;;)
+    {
+        t = next_event(&src);
+        if (t > until) break;
+        if (t > SimNow) SimNow = t;
+        if (SimNow >= SimEnd) sim_finish("time limit");
+        if (src == 0) { if (Role == 1) i2c_master_step(&FwM); else i2c_slave_step(&FwS); }
+        else if (src == 1) Peer->run();
+        else t_fire(&Timer[src - 2]);
+        take_interrupts();
+    }
+    if (until > SimNow) SimNow = until;
+    if (SimNow >= SimEnd) sim_finish("time limit");
+}
+
+void *sim_reg(int id)
+{
+    int i;
+    sync();
+    cycles(SimAccessCycles);
+    take_interrupts();
+    switch (id)
+    {
+    case R_UCB0RXBUF: //Buffer is freed at the next access, after the firmware has taken the byte
+        Reg[R_UCB0IFG] &= ~(UCRXIFG0 | UCRXIFG1 | UCRXIFG2 | UCRXIFG3);
+        RxRead = 1;
+        break;
+    case R_UCB0IV: Reg[id] = usci_iv(); break;
+    default:
+        for (i = 0; i < 3; i++)
+            if (id == Timer[i].base + T_R) Reg[id] = t_count(&Timer[i], SimNow);
+        break;
+    }
+    return &Reg[id];
+}
+
+void sim_sr_set(uint16_t bits)
+{
+    int src;
+    uint64_t t;
+    sync();
+    Sr |= bits;
+    vcd_cpu();
+    take_interrupts();
+    while (Sr & CPUOFF) //Sleep until an ISR clears the LPM bits on exit
+    {
+        t = next_event(&src);
+        if (t == SIM_NEVER) sim_finish("nothing left to wake the CPU");
+        run_due(t);
+    }
+    vcd_cpu();
+}
+
+void sim_sr_clear(uint16_t bits) { sync(); Sr &= ~bits; }
+void sim_sr_set_on_exit(uint16_t bits) { if (InIsr) IsrSr |= bits; else Sr |= bits; }
+void sim_sr_clear_on_exit(uint16_t bits) { if (InIsr) IsrSr &= ~bits; else Sr &= ~bits; }
+uint16_t sim_sr(void) { return Sr; }
+
+void sim_delay(uint32_t n)
+{
+    sync();
+    cycles(n);
+    take_interrupts();
+}
+
+void sim_set_peer(const sim_peer_t *peer) { Peer = peer; }
+
+int sim_vector(const char *spec)
+{
+    const char *eq = strchr(spec, '=');
+    unsigned v;
+    if (!eq) return -1;
+    for (v = 0; v < NVEC; v++)
+        if (strlen(Vec[v].vector) == (size_t)(eq - spec) && !strncmp(spec, Vec[v].vector, eq - spec))
+        {
+            VecOverride[v] = eq + 1;
+            return 0;
+        }
+    return -1;
+}
+
+void sim_finish(const char *why)
+{
+    static int done;
+    if (done) exit(0);
+    done = 1;
+    fprintf(stderr, "sim: stopped at %.3f ms: %s\n", SimNow / 1e6, why);
+    if (SimAtEnd) SimAtEnd();
+    if (Vcd)
+    {
+        fprintf(Vcd, "#%llu\n", (unsigned long long)SimNow);
+        fclose(Vcd);
+    }
+    exit(0);
+}
+
+void sim_start(void)
+{
+    unsigned v, n;
+    char name[8];
+    for (v = 0; v < NVEC; v++)
+    {
+        if (VecOverride[v]) Vec[v].fn = (void (*)(void))dlsym(RTLD_DEFAULT, VecOverride[v]);
+        for (n = 0; !Vec[v].fn && !VecOverride[v] && n < 3 && Vec[v].names[n]; n++)
+            Vec[v].fn = (void (*)(void))dlsym(RTLD_DEFAULT, Vec[v].names[n]);
+        if (Vec[v].fn) fprintf(stderr, "sim: %s_VECTOR -> %s\n", Vec[v].vector, VecOverride[v] ? VecOverride[v] : Vec[v].names[n - 1]);
+    }
+    Reg[R_UCB0CTLW0] = CtlShadow = 0x01C1; //Reset values
+    Reg[R_UCB0ADDMASK] = 0x3FF;
+    Reg[R_UCB0TXBUF] = 0xFFFF;
+    FwM = (struct i2c_master){ .dev = SIM_FW, .half = 5000, .wake = SIM_NEVER, .want_start = fm_want_start,
+        .want_stop = fm_want_stop, .address = fm_address, .tx = fm_tx, .rx_free = fm_rx_free, .rx = fm_rx,
+        .count = fm_count, .event = fm_event };
+    FwS = (struct i2c_slave){ .dev = SIM_FW, .wake = SIM_NEVER, .match = fs_match, .rx = fs_rx, .tx = fs_tx,
+        .event = fs_event };
+    for (v = 0; v < 3; v++) Timer[v].fire_k = SIM_NEVER;
+
+    VScl = sim_vcd_var("scl", 1);
+    VSda = sim_vcd_var("sda", 1);
+    Var[VScl].value = Var[VSda].value = 1;
+    VDrv[0][0] = sim_vcd_var("fw_scl_low", 1);
+    VDrv[0][1] = sim_vcd_var("fw_sda_low", 1);
+    VDrv[1][0] = sim_vcd_var("peer_scl_low", 1);
+    VDrv[1][1] = sim_vcd_var("peer_sda_low", 1);
+    VCpu = sim_vcd_var("cpu_active", 1);
+    Var[VCpu].value = 1;
+    VIsr = sim_vcd_var("in_isr", 1);
+    for (v = 0; v < 6; v++)
+    {
+        snprintf(name, sizeof name, "p%uout", v + 1);
+        VPort[v] = sim_vcd_var(name, 8);
+    }
+    vcd_header();
+    Started = 1;
+    fw_main();
+    sim_finish("firmware returned from main");
+}
@@ -0,0 +1,92 @@
+/* Host-side simulator for the demo firmware: registers, Timer_A0/A1/B0, eUSCI_B0 in I2C master or slave mode,
+   and a two-wire bus with a second device (the peer) supplied by the tool. Firmware is built against
+   host/msp430.h with main renamed to fw_main; see host/i2c_busmodel.c for the build line.
+   Time is in ns. The bus is open drain: a line is low while any device drives it low.
+   Device 0 is the firmware's eUSCI_B0, device 1 is the peer.
+*/
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <stdint.h>
+
+#define SIM_NEVER UINT64_MAX
+#define SIM_FW 0
+#define SIM_PEER 1
+
+/* Configuration, set before sim_start() */
+extern double SimMclk; //MCLK and SMCLK in Hz, default 1 MHz
+extern double SimAclk; //ACLK in Hz, default 10 kHz (VLO)
+extern uint64_t SimEnd; //Simulated time to stop at
+extern unsigned SimAccessCycles; //MCLK cycles charged per register access and the code around it, default 4
+
+extern uint64_t SimNow;
+extern void (*SimWatch)(void); //Called after every change of a line driver
+extern void (*SimAtEnd)(void); //Called once before exit
+
+/* Peer device on the bus */
+typedef struct {
+    uint64_t (*next)(void); //Time of the next timed action, SIM_NEVER if none
+    void (*run)(void); //Perform the actions due at SimNow
+    void (*edge)(int scl, int sda, int old_scl, int old_sda); //Line levels changed
+} sim_peer_t;
+
+void sim_set_peer(const sim_peer_t *peer);
+int sim_vector(const char *spec); //"VECTOR=function" overrides the ISR name for a vector
+int sim_vcd_open(const char *path);
+int sim_vcd_var(const char *name, int width); //Extra trace signal, declare before sim_start()
+void sim_vcd_set(int var, uint32_t value);
+void sim_start(void); //Runs the firmware; does not return
+void sim_finish(const char *why);
+
+void sim_drive(int dev, int scl_low, int sda_low);
+int sim_scl(void); //Line levels
+int sim_sda(void);
+int sim_driving_scl(int dev);
+int sim_fw_role(void); //0 = eUSCI in reset, 1 = master, 2 = slave
+int sim_cpu_active(void);
+int sim_in_isr(void);
+int sim_fw_stalled(void); //eUSCI holding SCL low until the firmware writes TXBUF or reads RXBUF
+
+/* Bit-level I2C master. Timed steps run from i2c_master_step() when SimNow reaches wake; the hooks connect
+   it to registers (firmware eUSCI) or to a script (peer). */
+enum { M_EV_START, M_EV_ADDR_ACK, M_EV_NACK, M_EV_BYTE, M_EV_STOP };
+struct i2c_master {
+    int dev;
+    uint64_t half; //Half SCL period in ns
+    int state, kind, bit, ack, nack_sent, bytes;
+    uint8_t shift, addr;
+    uint64_t wake;
+    int stalled; //Holding SCL low until a hook is ready
+    int (*want_start)(struct i2c_master *m);
+    int (*want_stop)(struct i2c_master *m);
+    uint8_t (*address)(struct i2c_master *m); //Address byte including R/W
+    int (*tx)(struct i2c_master *m, uint8_t *b); //1 when a byte is available
+    int (*rx_free)(struct i2c_master *m);
+    void (*rx)(struct i2c_master *m, uint8_t b);
+    unsigned (*count)(struct i2c_master *m); //Bytes after which to stop automatically, 0 = none
+    void (*event)(struct i2c_master *m, int ev);
+    void *ctx;
+};
+void i2c_master_reset(struct i2c_master *m);
+void i2c_master_step(struct i2c_master *m); //Timed action or re-check after a hook became ready
+void i2c_master_edge(struct i2c_master *m);
+
+/* Bit-level I2C slave driven by the line edges */
+enum { S_EV_STOP, S_EV_RESTART };
+struct i2c_slave {
+    int dev;
+    int state, rises, acking, rw, master_ack, stalled;
+    uint8_t shift, txbyte;
+    uint64_t wake; //End of a stretch requested through hold
+    uint64_t hold; //Set by a hook to stretch SCL for this long after the current action
+    int (*match)(struct i2c_slave *s, uint8_t addr); //1 to acknowledge the address byte
+    int (*rx)(struct i2c_slave *s, uint8_t b); //1 ACK, 0 NACK, -1 not ready (stretch)
+    int (*tx)(struct i2c_slave *s, uint8_t *b); //1 when a byte is available, else stretch
+    void (*event)(struct i2c_slave *s, int ev);
+    void *ctx;
+};
+void i2c_slave_reset(struct i2c_slave *s);
+void i2c_slave_step(struct i2c_slave *s); //End of a hold or re-check after a hook became ready
+void i2c_slave_edge(struct i2c_slave *s, int scl, int sda, int old_scl, int old_sda);
+
+#endif